@@ -36,7 +36,8 @@
 `default_nettype none
 
 module hdmi_text_2x #(
-	parameter integer DW = 4
+	parameter integer DW = 4,
+	parameter integer TGEN_RUNTIME = 0
 )(
 	// HDMI pads
 	output wire [DW-1:0] hdmi_data,
@@ -63,6 +64,9 @@ module hdmi_text_2x #(
 	// -------
 
 	// Timing generator
+	reg  [95:0] tg_cfg;
+	reg  tg_commit;
+
 	wire tg_hsync;
 	wire tg_vsync;
 	wire tg_active;
@@ -87,7 +91,35 @@ module hdmi_text_2x #(
 	// Timing generation
 	// -----------------
 
-	vid_tgen tgen_I (
+	// Runtime config registers (0x4110-0x4118)
+	//  The bus accesses are acked by vid_text, we just capture the writes.
+	//  8 timing values (H FP/Sync/BP/Active, V FP/Sync/BP/Active) and a
+	//  write to 0x4118 commits them (applied at next vsync). Reset values
+	//  match the vid_tgen defaults (1080p).
+	always @(posedge clk_1x)
+		if (rst)
+			tg_cfg <= {
+				12'd1080, 12'd36, 12'd5, 12'd4,
+				12'd960, 12'd74, 12'd22, 12'd44
+			};
+		else if (bus_cyc & bus_we & bus_ack & (bus_addr[15:3] == 13'h0822))
+			tg_cfg[12*bus_addr[2:0]+:12] <= bus_din[11:0];
+
+	always @(posedge clk_1x)
+		tg_commit <= bus_cyc & bus_we & bus_ack & (bus_addr == 16'h4118);
+
+	vid_tgen #(
+		.RUNTIME(TGEN_RUNTIME)
+	) tgen_I (
+		.cfg_h_fp(tg_cfg[11:0]),
+		.cfg_h_sync(tg_cfg[23:12]),
+		.cfg_h_bp(tg_cfg[35:24]),
+		.cfg_h_active(tg_cfg[47:36]),
+		.cfg_v_fp(tg_cfg[59:48]),
+		.cfg_v_sync(tg_cfg[71:60]),
+		.cfg_v_bp(tg_cfg[83:72]),
+		.cfg_v_active(tg_cfg[95:84]),
+		.cfg_commit(tg_commit),
 		.vid_hsync(tg_hsync),
 		.vid_vsync(tg_vsync),
 		.vid_active(tg_active),
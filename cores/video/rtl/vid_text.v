@@ -73,6 +73,19 @@ module vid_text (
 	wire cl_stb_3;
 	wire cl_valid_3;
 
+	// Line table / Scroll origin
+	reg  lt_fetch_0;
+	wire lt_valid_3;
+	wire [15:0] lt_data_3;
+
+	reg  [ 7:0] org_x;
+	reg  [ 5:0] org_y;
+	reg  [ 7:0] org_x_v;
+	reg  [ 5:0] org_y_v;
+
+	reg  [ 5:0] sm_row;
+	reg  [ 7:0] sm_col;
+
 	wire [15:0] cl_char_4;
 
 	// Glyph look-up
@@ -124,9 +137,15 @@ module vid_text (
 	reg  cmb_zero;
 	reg  cmb_write;
 
+	wire lmb_ready;
+	reg  lmb_read;
+	reg  lmb_zero;
+	reg  lmb_write;
+
 	wire [15:0] smb_dout;
 	wire [15:0] gmb_dout;
 	wire [15:0] cmb_dout;
+	wire [15:0] lmb_dout;
 
 	// Bus interface
 	reg  smb_req;
@@ -138,6 +157,13 @@ module vid_text (
 	reg  cmb_req;
 	wire cmb_clear;
 
+	reg  lmb_req;
+	wire lmb_clear;
+
+	reg  rgb_req;
+	reg  rgb_write;
+	wire rgb_clear;
+
 	reg  bus_ack_wait;
 	wire bus_req_ok;
 	reg  [2:0] bus_req_ok_dly;
@@ -157,10 +183,10 @@ module vid_text (
 	always @(posedge clk)
 		cl_y_cnt_1 <= cl_y_cnt_0[9:0];
 
-	// X counter
+	// X counter (starts at the line X origin)
 	always @(posedge clk)
 		if (vid_h_first_0)
-			cl_x_cnt_1  <= 0;
+			cl_x_cnt_1  <= { sm_col, 2'b00 };
 		else
 			cl_x_cnt_1  <= cl_x_cnt_1 + 1;
 
@@ -173,7 +199,7 @@ module vid_text (
 		cl_fetch_1 <= ~cl_y_cnt_0[10] & vid_active_0 & (vid_h_first_0 | (cl_x_cnt_1[1:0] == 3'b11));
 
 	// RAM interface
-	assign sm_addr_1 = { cl_y_cnt_1[9:4], cl_x_cnt_1[9:2] };
+	assign sm_addr_1 = { sm_row, cl_x_cnt_1[9:2] };
 	assign sm_read_1 = cl_fetch_1;
 
 	assign cl_char_4 = sm_data_4;
@@ -183,6 +209,34 @@ module vid_text (
 	delay_bit #(2) dly_valid13 ( .d(cl_valid_1), .q(cl_valid_3), .clk(clk) );
 
 
+	// Line table / Scroll origin
+	// --------------------------
+
+	// Global origin only changes at frame start
+	always @(posedge clk)
+		if (vid_v_first_0) begin
+			org_x_v <= org_x;
+			org_y_v <= org_y;
+		end
+
+	// Fetch the line table entry of the next line during h-blank
+	// (cl_y_cnt_0 already points to the next line after h_last)
+	always @(posedge clk)
+		lt_fetch_0 <= vid_h_last_0;
+
+	delay_bit #(3) dly_lt_valid ( .d(lt_fetch_0), .q(lt_valid_3), .clk(clk) );
+
+	// Compute the screen memory row / start column for that line
+	//  lt_data[15]   : Fixed (ignore global origin)
+	//  lt_data[13:8] : Y offset
+	//  lt_data[ 7:0] : X offset
+	always @(posedge clk)
+		if (lt_valid_3) begin
+			sm_row <= cl_y_cnt_0[9:4] + lt_data_3[13:8] + (lt_data_3[15] ? 6'd0 : org_y_v);
+			sm_col <= lt_data_3[7:0] + (lt_data_3[15] ? 8'd0 : org_x_v);
+		end
+
+
 	// Glyph lookup
 	// ------------
 
@@ -333,6 +387,26 @@ module vid_text (
 	);
 
 
+	// Line table (one entry per text row)
+	vid_shared_ram #(
+		.TYPE("EBR")
+	) line_mem_I (
+		.p_addr_0({2'b00, cl_y_cnt_0[9:4]}),
+		.p_read_0(lt_fetch_0),
+		.p_zero_0(1'b0),
+		.p_dout_3(lt_data_3),
+		.s_addr_0(bus_addr[7:0]),
+		.s_din_0(bus_din),
+		.s_read_0(lmb_read),
+		.s_zero_0(lmb_zero),
+		.s_write_0(lmb_write),
+		.s_dout_3(lmb_dout),
+		.s_ready_0(lmb_ready),
+		.clk(clk),
+		.rst(rst)
+	);
+
+
 	// External bus interface
 	// ----------------------
 
@@ -376,14 +450,51 @@ module vid_text (
 			cmb_req   <= (bus_addr[15:13] == 3'b011);
 		end
 
+	always @(posedge clk)
+		if (lmb_clear) begin
+			lmb_read  <= 1'b0;
+			lmb_zero  <= 1'b0;
+			lmb_write <= 1'b0;
+			lmb_req   <= 1'b0;
+		end else begin
+			lmb_read  <= (bus_addr[15:13] == 3'b010) & ~bus_addr[8] & ~bus_we;
+			lmb_zero  <= (bus_addr[15:13] != 3'b010) |  bus_addr[8];
+			lmb_write <= (bus_addr[15:13] == 3'b010) & ~bus_addr[8] & bus_we;
+			lmb_req   <= (bus_addr[15:13] == 3'b010) & ~bus_addr[8];
+		end
+
+	// Registers are write only and always ready
+	always @(posedge clk)
+		if (rgb_clear) begin
+			rgb_write <= 1'b0;
+			rgb_req   <= 1'b0;
+		end else begin
+			rgb_write <= (bus_addr[15:13] == 3'b010) & bus_addr[8] & bus_we;
+			rgb_req   <= (bus_addr[15:13] == 3'b010) & bus_addr[8];
+		end
+
+	always @(posedge clk)
+		if (rst) begin
+			org_x <= 8'h00;
+			org_y <= 6'h00;
+		end else if (rgb_write & (bus_addr[7:1] == 7'h00)) begin
+			if (~bus_addr[0])
+				org_x <= bus_din[7:0];
+			else
+				org_y <= bus_din[5:0];
+		end
+
 	// Condition to force the requests to zero :
 	//  no access needed, ack pending or this cycle went through
 	assign smb_clear = ~bus_cyc | bus_ack_wait | (smb_req & smb_ready);
 	assign gmb_clear = ~bus_cyc | bus_ack_wait | (gmb_req & gmb_ready);
 	assign cmb_clear = ~bus_cyc | bus_ack_wait | (cmb_req & cmb_ready);
+	assign lmb_clear = ~bus_cyc | bus_ack_wait | (lmb_req & lmb_ready);
+	assign rgb_clear = ~bus_cyc | bus_ack_wait | rgb_req;
 
 	// Track when request are accepted by the RAM
-	assign bus_req_ok = (smb_req & smb_ready) | (gmb_req & gmb_ready) | (cmb_req & cmb_ready);
+	assign bus_req_ok = (smb_req & smb_ready) | (gmb_req & gmb_ready) | (cmb_req & cmb_ready) |
+	                    (lmb_req & lmb_ready) | rgb_req;
 
 	always @(posedge clk)
 		bus_req_ok_dly <= { bus_req_ok_dly[1:0], bus_req_ok & ~bus_we };
@@ -400,7 +511,7 @@ module vid_text (
 
 	// Output is simply the OR of all memory since we force them to zero if
 	// they're not accessed
-	assign bus_dout = smb_dout | gmb_dout | cmb_dout;
+	assign bus_dout = smb_dout | gmb_dout | cmb_dout | lmb_dout;
 
 endmodule // vid_text
 
@@ -49,8 +49,21 @@ module vid_tgen #(
 	parameter integer V_FP     =    4,
 	parameter integer V_SYNC   =    5,
 	parameter integer V_BP     =   36,
-	parameter integer V_ACTIVE = 1080
+	parameter integer V_ACTIVE = 1080,
+	parameter integer RUNTIME  = 0		// Enable runtime config
 )(
+	// Runtime config (sizes, only used if RUNTIME=1)
+	input  wire [H_WIDTH-1:0] cfg_h_fp,
+	input  wire [H_WIDTH-1:0] cfg_h_sync,
+	input  wire [H_WIDTH-1:0] cfg_h_bp,
+	input  wire [H_WIDTH-1:0] cfg_h_active,
+	input  wire [V_WIDTH-1:0] cfg_v_fp,
+	input  wire [V_WIDTH-1:0] cfg_v_sync,
+	input  wire [V_WIDTH-1:0] cfg_v_bp,
+	input  wire [V_WIDTH-1:0] cfg_v_active,
+	input  wire               cfg_commit,
+
+	// Video timing output
 	output reg  vid_hsync,
 	output reg  vid_vsync,
 	output reg  vid_active,
@@ -89,6 +102,80 @@ module vid_tgen #(
 	wire v_ce;
 	reg  v_ce_r;
 
+	// Current timings (size - 2)
+	wire [H_WIDTH-1:0] t_h_fp;
+	wire [H_WIDTH-1:0] t_h_sync;
+	wire [H_WIDTH-1:0] t_h_bp;
+	wire [H_WIDTH-1:0] t_h_active;
+	wire [V_WIDTH-1:0] t_v_fp;
+	wire [V_WIDTH-1:0] t_v_sync;
+	wire [V_WIDTH-1:0] t_v_bp;
+	wire [V_WIDTH-1:0] t_v_active;
+	wire t_reload;
+
+	// Timings
+	assign t_reload = v_ce & v_last & (v_zone == Z_FP);	// Entering vsync
+
+	generate
+		if (RUNTIME) begin
+			reg [H_WIDTH-1:0] r_h_fp;
+			reg [H_WIDTH-1:0] r_h_sync;
+			reg [H_WIDTH-1:0] r_h_bp;
+			reg [H_WIDTH-1:0] r_h_active;
+			reg [V_WIDTH-1:0] r_v_fp;
+			reg [V_WIDTH-1:0] r_v_sync;
+			reg [V_WIDTH-1:0] r_v_bp;
+			reg [V_WIDTH-1:0] r_v_active;
+			reg               r_pending;
+
+			// New config is only applied at the next vsync
+			always @(posedge clk or posedge rst)
+				if (rst)
+					r_pending <= 1'b0;
+				else
+					r_pending <= (r_pending & ~t_reload) | cfg_commit;
+
+			always @(posedge clk or posedge rst)
+				if (rst) begin
+					r_h_fp     <= H_FP     - 2;
+					r_h_sync   <= H_SYNC   - 2;
+					r_h_bp     <= H_BP     - 2;
+					r_h_active <= H_ACTIVE - 2;
+					r_v_fp     <= V_FP     - 2;
+					r_v_sync   <= V_SYNC   - 2;
+					r_v_bp     <= V_BP     - 2;
+					r_v_active <= V_ACTIVE - 2;
+				end else if (t_reload & r_pending) begin
+					r_h_fp     <= cfg_h_fp     - 2;
+					r_h_sync   <= cfg_h_sync   - 2;
+					r_h_bp     <= cfg_h_bp     - 2;
+					r_h_active <= cfg_h_active - 2;
+					r_v_fp     <= cfg_v_fp     - 2;
+					r_v_sync   <= cfg_v_sync   - 2;
+					r_v_bp     <= cfg_v_bp     - 2;
+					r_v_active <= cfg_v_active - 2;
+				end
+
+			assign t_h_fp     = r_h_fp;
+			assign t_h_sync   = r_h_sync;
+			assign t_h_bp     = r_h_bp;
+			assign t_h_active = r_h_active;
+			assign t_v_fp     = r_v_fp;
+			assign t_v_sync   = r_v_sync;
+			assign t_v_bp     = r_v_bp;
+			assign t_v_active = r_v_active;
+		end else begin
+			assign t_h_fp     = H_FP     - 2;
+			assign t_h_sync   = H_SYNC   - 2;
+			assign t_h_bp     = H_BP     - 2;
+			assign t_h_active = H_ACTIVE - 2;
+			assign t_v_fp     = V_FP     - 2;
+			assign t_v_sync   = V_SYNC   - 2;
+			assign t_v_bp     = V_BP     - 2;
+			assign t_v_active = V_ACTIVE - 2;
+		end
+	endgenerate
+
 	// Horizontal Counter
 	assign h_dec  = h_cnt - 1;
 	assign h_last = h_cnt[H_WIDTH];
@@ -111,10 +198,10 @@ module vid_tgen #(
 
 		if (h_last)
 			case (h_zone)
-				Z_FP:     h_mux = H_SYNC   - 2;
-				Z_SYNC:   h_mux = H_BP     - 2;
-				Z_BP:     h_mux = H_ACTIVE - 2;
-				Z_ACTIVE: h_mux = H_FP     - 2;
+				Z_FP:     h_mux = { 1'b0, t_h_sync   };
+				Z_SYNC:   h_mux = { 1'b0, t_h_bp     };
+				Z_BP:     h_mux = { 1'b0, t_h_active };
+				Z_ACTIVE: h_mux = { 1'b0, t_h_fp     };
 			endcase
 	end
 
@@ -150,10 +237,10 @@ module vid_tgen #(
 
 		if (v_last)
 			case (v_zone)
-				Z_FP:     v_mux = V_SYNC   - 2;
-				Z_SYNC:   v_mux = V_BP     - 2;
-				Z_BP:     v_mux = V_ACTIVE - 2;
-				Z_ACTIVE: v_mux = V_FP     - 2;
+				Z_FP:     v_mux = { 1'b0, t_v_sync   };
+				Z_SYNC:   v_mux = { 1'b0, t_v_bp     };
+				Z_BP:     v_mux = { 1'b0, t_v_active };
+				Z_ACTIVE: v_mux = { 1'b0, t_v_fp     };
 			endcase
 	end
 
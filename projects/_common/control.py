@@ -1,7 +1,12 @@
 #!/usr/bin/env python3
 
+import contextlib
+import queue
 import struct
+import threading
+import time
 
+from pyftdi.ftdi import Ftdi
 from pyftdi.spi import SpiController
 
 
@@ -11,13 +16,18 @@ class BoardControlBase(object):
 		# SPI link
 		self.spi_frequency = spi_frequency
 		self.spi = SpiController(cs_count=3)
-		self.spi.configure(addr)
+		self.spi.configure(addr, frequency=self.spi_frequency)
 
 		if spi_cs is not None:
 			self.slave = self.spi.get_port(cs=spi_cs, freq=self.spi_frequency, mode=0)
 		else:
 			self.slave = self._spi_probe()
 
+		# Write queue (see batch())
+		self._wq = None
+		self._wq_len = 0
+		self._wq_depth = 0
+
 	def _spi_probe(self):
 		for cs in [0, 2]:
 			port = self.spi.get_port(cs=cs, freq=self.spi_frequency, mode=0)
@@ -26,20 +36,153 @@ class BoardControlBase(object):
 				return port
 		raise RuntimeError('Automatic SPI CS probe failed')
 
+	def _mpsse_write(self, data):
+		# Raw MPSSE sequence for one write-only SPI transaction (mode 0)
+		# CS are on ADBUS3+, SCK on ADBUS0, DO on ADBUS1.
+		d = self.spi.direction & 0xff
+		cs_idle = 0x38
+		cs_sel  = cs_idle & ~(0x08 << self.slave.cs)
+		l = len(data) - 1
+		return (
+			bytes([ Ftdi.SET_BITS_LOW, cs_sel, d ]) +
+			bytes([ Ftdi.WRITE_BYTES_NVE_MSB, l & 0xff, l >> 8 ]) +
+			bytes(data) +
+			bytes([ Ftdi.SET_BITS_LOW, cs_sel,  d ]) +
+			bytes([ Ftdi.SET_BITS_LOW, cs_idle, d ])
+		)
+
+	def spi_write(self, data):
+		# Direct
+		if (self._wq is None) or (len(data) > 65536):
+			self.flush()
+			self.slave.exchange(data)
+			return
+
+		# Queued
+		self._wq.append(self._mpsse_write(data))
+		self._wq_len += len(data)
+
+		if self._wq_len >= 32768:
+			self.flush()
+
+	def spi_idle(self, t):
+		"""Keep the SPI bus idle (CS released) for at least 't' seconds
+		before any following write, by clocking dummy bytes"""
+		n = max(int(t * self.spi_frequency / 8) + 1, 1)
+		while n:
+			l = min(n, 65536)
+			cmd = bytes([ Ftdi.CLK_BYTES, (l-1) & 0xff, (l-1) >> 8 ])
+			if self._wq is None:
+				self.spi.ftdi.write_data(cmd)
+			else:
+				self._wq.append(cmd)
+			n -= l
+
+	def flush(self):
+		if self._wq:
+			self.spi.ftdi.write_data(b''.join(self._wq))
+			self._wq.clear()
+			self._wq_len = 0
+
+	@contextlib.contextmanager
+	def batch(self):
+		"""Queue all register writes issued in the block and send them as
+		a single MPSSE buffer (i.e. one USB transfer) on exit or on the next
+		read. Can be nested."""
+		if self._wq is None:
+			self._wq = []
+		self._wq_depth += 1
+		try:
+			yield self
+		finally:
+			self._wq_depth -= 1
+			if self._wq_depth == 0:
+				self.flush()
+				self._wq = None
+
 	def reg_w16(self, reg, v):
-		self.slave.exchange(struct.pack('>BH', reg, v))
+		self.spi_write(struct.pack('>BH', reg, v))
 
 	def reg_w8(self, reg, v):
-		self.slave.exchange(struct.pack('>BB', reg, v))
+		self.spi_write(struct.pack('>BB', reg, v))
 
 	def reg_burst(self, reg, data):
-		self.slave.exchange(bytearray([reg]) + data)
+		self.spi_write(bytearray([reg]) + data)
 
 	def read_status(self):
+		self.flush()
 		rv = self.slave.exchange(bytearray(2), duplex=True)
 		return rv[0] | rv[1]
 
 
+class FrameReader(object):
+	"""Reads (and optionally converts) fixed size frames from a file or pipe
+	in a background thread, into a bounded queue. Iterating over the object
+	returns the frames in order, so file I/O and conversion overlap with
+	the sending of the previous frames."""
+
+	def __init__(self, fh, frame_size, loop=False, convert=None, depth=4):
+		self.fh = fh
+		self.frame_size = frame_size
+		self.loop = loop
+		self.convert = convert
+		self.queue = queue.Queue(maxsize=depth)
+		self.thread = threading.Thread(target=self._run, daemon=True)
+		self.thread.start()
+
+	def _run(self):
+		try:
+			while True:
+				data = self.fh.read(self.frame_size)
+
+				if len(data) != self.frame_size:
+					if self.loop and self.fh.seekable():
+						self.fh.seek(0)
+						continue
+					break
+
+				if self.convert is not None:
+					data = self.convert(data)
+
+				self.queue.put(data)
+		finally:
+			self.queue.put(None)
+
+	def __iter__(self):
+		while True:
+			frame = self.queue.get()
+			if frame is None:
+				return
+			yield frame
+
+
+class FramePacer(object):
+	"""Regulates a loop to a target FPS, based on a monotonic clock and
+	without drift accumulation (None = no regulation)"""
+
+	def __init__(self, fps=None):
+		self.tpf = (1.0 / fps) if fps else None
+		self.tt  = None
+
+	def wait(self):
+		if self.tpf is None:
+			return
+
+		now = time.monotonic()
+
+		if self.tt is None:
+			self.tt = now + self.tpf
+			return
+
+		w = self.tt - now
+		if w > 0:
+			time.sleep(w)
+			self.tt += self.tpf
+		else:
+			# Late, don't try to catch up by bursting frames
+			self.tt = now + self.tpf
+
+
 def arg_group_setup(group):
 	group.add_argument('--spi-freq',  type=float, help='SPI frequency in MHz', default=30.0)
 	group.add_argument('--spi-cs',    type=int,   help='SPI slave select id (-1 = probe)', default=-1)
@@ -74,8 +74,19 @@ module top (
 	wire [7:0] sb_out;
 
 	// Bridge
-	reg [31:0] data;
-	reg pending;
+	reg  [ 7:0] data;
+	reg  [ 2:0] pos;
+	wire [ 2:0] pos_cur;
+	reg  [15:0] addr;
+	wire [31:0] wf_wdata;
+	wire        wf_wena;
+	wire        wf_full;
+	wire [31:0] wf_rdata;
+	wire        wf_rena;
+	wire        wf_empty;
+	reg  [15:0] wr_addr;
+	reg  [15:0] wr_data;
+	reg  pending;
 
 	// Clocks / Reset
 	wire clk_2x;
@@ -104,28 +115,94 @@ module top (
 
 	// Slow -> Fast bus bridge
 	// -----------------------
+	//
+	// Command 0x00: Single write   [addr_hi, addr_lo, data_hi, data_lo]
+	// Command 0x01: Burst write    [addr_hi, addr_lo, (data_hi, data_lo) * N]
+	//               (address auto-increments after each word)
+	//
+	// Each complete word is queued in a FIFO so the next ones can be
+	// received while the bus access is in progress. Most accesses only
+	// take a few cycles but color memory is only accessible during
+	// blanking, so a write to it can stall for most of a line and only a
+	// few tens of them complete per line. The 256 words FIFO absorbs any
+	// burst covering the whole color memory, longer color memory writes
+	// must be paced by the host. Words received while it's full are
+	// dropped.
+	//
+
+	// Byte position within the transaction
+	//  0,1 : Address
+	//  2,3 : Data word
+	//  4   : Ignore (single write mode only)
+	assign pos_cur = sb_first ? 3'd0 : pos;
 
-	assign fbus_din  = data[15:0];
-	assign fbus_addr = data[31:16];
-	assign fbus_cyc  = pending;
-	assign fbus_we   = 1'b1;
+	always @(posedge clk_1x)
+		if (sb_stb)
+			case (pos_cur)
+				3'd3:    pos <= sb_addr[0] ? 3'd2 : 3'd4;
+				3'd4:    pos <= 3'd4;
+				default: pos <= pos_cur + 1;
+			endcase
+
+	// Data shift
+	always @(posedge clk_1x)
+		if (sb_stb)
+			data <= sb_data;
+
+	// Address
+	always @(posedge clk_1x)
+		if (sb_stb & (pos_cur == 3'd1))
+			addr <= { data, sb_data };
+		else if (sb_stb & (pos_cur == 3'd3))
+			addr <= addr + 1;
+
+	// Write queue
+	fifo_sync_ram #(
+		.DEPTH(256),
+		.WIDTH(32)
+	) wfifo_I (
+		.wr_data  (wf_wdata),
+		.wr_ena   (wf_wena),
+		.wr_full  (wf_full),
+		.rd_data  (wf_rdata),
+		.rd_ena   (wf_rena),
+		.rd_empty (wf_empty),
+		.clk      (clk_1x),
+		.rst      (rst)
+	);
+
+	assign wf_wdata = { addr, data, sb_data };
+	assign wf_wena  = sb_stb & (pos_cur == 3'd3) &
+		(addr[15] | addr[14]) &	// Only mapped areas
+		~wf_full;
+
+	// Write request
+	assign wf_rena = ~wf_empty & ~pending;
+
+	always @(posedge clk_1x)
+		if (wf_rena) begin
+			wr_addr <= wf_rdata[31:16];
+			wr_data <= wf_rdata[15:0];
+		end
 
 	always @(posedge clk_1x)
 		if (rst)
 			pending <= 1'b0;
 		else
-			pending <= (pending & ~fbus_ack) | (sb_last & sb_stb & |(data[24:22]));
+			pending <= (pending & ~fbus_ack) | wf_rena;
 
-	always @(posedge clk_1x)
-		if (sb_stb & ~pending)
-			data <= { data[24:0], sb_data };
+	assign fbus_din  = wr_data;
+	assign fbus_addr = wr_addr;
+	assign fbus_cyc  = pending;
+	assign fbus_we   = 1'b1;
 
 
 	// HDMI text mode core
 	// -------------------
 
 	hdmi_text_2x #(
-		.DW(4)
+		.DW(4),
+		.TGEN_RUNTIME(1)
 	) text_I (
 		.hdmi_data({hdmi_i, hdmi_b, hdmi_g, hdmi_r}),
 		.hdmi_hsync(hdmi_hsync),
@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+
+import argparse
+import struct
+
+from PIL import Image
+
+
+def font_from_image(img, cw=9, ch=17):
+	# Input is a 16x16 grid of glyphs, each in a cw x ch cell
+	# (only the top-left 8x16 pixels of each cell are used)
+	img = img.convert('RGB').getchannel('R')
+	glyphs = []
+
+	for i in range(0x0000, 0x2000):
+		c = (i >> 5)
+		fx = (c & 0xf) * cw
+		fy = ((c >> 4) & 0xf) * ch
+		cx = (i & 0x01) * 4
+		cy = (i & 0x1e) >> 1
+
+		glyphs.append(
+			((img.getpixel( (fx+cx+0, fy+cy) ) >> 7) << 12) |
+			((img.getpixel( (fx+cx+1, fy+cy) ) >> 7) <<  8) |
+			((img.getpixel( (fx+cx+2, fy+cy) ) >> 7) <<  4) |
+			((img.getpixel( (fx+cx+3, fy+cy) ) >> 7) <<  0)
+		)
+
+	return glyphs
+
+
+def font_to_blob(glyphs):
+	# Glyph memory image, big endian words (same order as on the SPI bus)
+	return struct.pack('>%dH' % len(glyphs), *glyphs)
+
+
+def main():
+	# Parse options
+	parser = argparse.ArgumentParser(
+		description='Converts a font image to a vid_text glyph memory blob',
+		formatter_class=argparse.ArgumentDefaultsHelpFormatter
+	)
+	parser.add_argument('input',  help='Input font image (16x16 glyphs grid)')
+	parser.add_argument('output', help='Output glyph memory blob')
+	parser.add_argument('--cell-width',  type=int, metavar='N', help='Width of each cell in the image',  default=9)
+	parser.add_argument('--cell-height', type=int, metavar='N', help='Height of each cell in the image', default=17)
+
+	args = parser.parse_args()
+
+	# Convert
+	glyphs = font_from_image(Image.open(args.input), args.cell_width, args.cell_height)
+
+	with open(args.output, 'wb') as fh:
+		fh.write(font_to_blob(glyphs))
+
+
+if __name__ == '__main__':
+	main()
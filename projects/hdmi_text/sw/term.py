@@ -0,0 +1,285 @@
+#!/usr/bin/env python3
+
+import argparse
+import os
+import select
+import sys
+import time
+
+import control
+import text
+
+
+class TextTerminal(object):
+	"""Minimal VT100 subset terminal rendering into the vid_text screen
+	memory. Keeps a shadow of the screen and of what was last sent to the
+	hardware so flush() only writes the cells that changed, coalesced in
+	bursts. Scrolling uses the hardware Y origin so only the new line
+	needs to be written."""
+
+	N_COLS = 240
+	N_ROWS = 64		# Must match the screen memory for hardware scroll
+
+	# Max number of unchanged cells to include in a burst rather than
+	# starting a new one (a new burst costs 3 bytes of overhead)
+	RUN_GAP = 2
+
+	def __init__(self, tc, n_cols=N_COLS):
+		# Text core control
+		self.tc = tc
+
+		# Geometry
+		self.n_cols = n_cols
+		self.n_rows = self.N_ROWS
+
+		# Screen state (shadow and what the hardware has)
+		# (indexed by screen memory row, not by on-screen row)
+		self.screen = [ [ 0 ] * self.n_cols for y in range(self.n_rows) ]
+		self.hw     = [ [ None ] * self.n_cols for y in range(self.n_rows) ]
+		self.dirty  = set(range(self.n_rows))
+
+		# Scroll origin (and what the hardware has)
+		self.org    = 0
+		self.hw_org = None
+
+		# Terminal state
+		self.reset()
+
+	# Attributes
+	# ----------
+
+	def _attr(self):
+		fg, bg = (self.bg, self.fg) if self.reverse else (self.fg, self.bg)
+		return (fg << 13) | (bg << 10) | (1 << 9)
+
+	def _blank(self):
+		return self._attr() | 0x20
+
+	# Screen operations
+	# -----------------
+
+	def _put(self, x, y, w):
+		y = (y + self.org) % self.n_rows
+		if self.screen[y][x] != w:
+			self.screen[y][x] = w
+			self.dirty.add(y)
+
+	def _clear(self, y, x0=0, x1=None):
+		b = self._blank()
+		for x in range(x0, self.n_cols if x1 is None else x1):
+			self._put(x, y, b)
+
+	def _scroll_up(self):
+		# Move the origin, the old top row becomes the new bottom one
+		self.org = (self.org + 1) % self.n_rows
+		self._clear(self.n_rows - 1)
+
+	def _newline(self):
+		if self.y == (self.n_rows - 1):
+			self._scroll_up()
+		else:
+			self.y += 1
+
+	def reset(self):
+		self.x = 0
+		self.y = 0
+		self.fg = 7
+		self.bg = 0
+		self.reverse = False
+		self.state = 'normal'
+		self.params = ''
+		for y in range(self.n_rows):
+			self._clear(y)
+
+	# Escape sequences
+	# ----------------
+
+	def _csi(self, final, params):
+		p = [ int(v) if v.isdigit() else 0 for v in params.split(';') ] if params else []
+		p0 = p[0] if p else 0
+		n  = p0 or 1
+
+		if final == 'A':
+			self.y = max(self.y - n, 0)
+		elif final == 'B':
+			self.y = min(self.y + n, self.n_rows - 1)
+		elif final == 'C':
+			self.x = min(self.x + n, self.n_cols - 1)
+		elif final == 'D':
+			self.x = max(self.x - n, 0)
+		elif final in 'Hf':
+			self.y = min(max((p[0] if len(p) > 0 else 1) - 1, 0), self.n_rows - 1)
+			self.x = min(max((p[1] if len(p) > 1 else 1) - 1, 0), self.n_cols - 1)
+		elif final == 'J':
+			if p0 == 0:
+				self._clear(self.y, self.x)
+				for y in range(self.y + 1, self.n_rows):
+					self._clear(y)
+			elif p0 == 1:
+				for y in range(self.y):
+					self._clear(y)
+				self._clear(self.y, 0, self.x + 1)
+			else:
+				for y in range(self.n_rows):
+					self._clear(y)
+		elif final == 'K':
+			if p0 == 0:
+				self._clear(self.y, self.x)
+			elif p0 == 1:
+				self._clear(self.y, 0, self.x + 1)
+			else:
+				self._clear(self.y)
+		elif final == 'm':
+			for v in (p or [0]):
+				if v == 0:
+					self.fg, self.bg, self.reverse = 7, 0, False
+				elif v == 7:
+					self.reverse = True
+				elif v == 27:
+					self.reverse = False
+				elif 30 <= v <= 37:
+					self.fg = v - 30
+				elif v == 39:
+					self.fg = 7
+				elif 40 <= v <= 47:
+					self.bg = v - 40
+				elif v == 49:
+					self.bg = 0
+
+	# Input
+	# -----
+
+	def write(self, s):
+		for c in s:
+			if self.state == 'esc':
+				if c == '[':
+					self.state = 'csi'
+					self.params = ''
+				else:
+					if c == 'c':
+						self.reset()
+					self.state = 'normal'
+
+			elif self.state == 'csi':
+				if c.isdigit() or c == ';':
+					self.params += c
+				elif c == '?':
+					pass
+				else:
+					self._csi(c, self.params)
+					self.state = 'normal'
+
+			elif c == '\x1b':
+				self.state = 'esc'
+
+			elif c == '\n':
+				# Assume cooked output (LF implies CR)
+				self.x = 0
+				self._newline()
+
+			elif c == '\r':
+				self.x = 0
+
+			elif c == '\b':
+				self.x = max(self.x - 1, 0)
+
+			elif c == '\t':
+				self.x = min((self.x + 8) & ~7, self.n_cols - 1)
+
+			elif ord(c) >= 0x20:
+				if self.x >= self.n_cols:
+					self.x = 0
+					self._newline()
+				self._put(self.x, self.y, self._attr() | (ord(c) & 0xff))
+				self.x += 1
+
+	# Output
+	# ------
+
+	def flush(self):
+		with self.tc.batch():
+			for y in sorted(self.dirty):
+				row_s = self.screen[y]
+				row_h = self.hw[y]
+				x = 0
+
+				while x < self.n_cols:
+					# Find start of a changed run
+					if row_s[x] == row_h[x]:
+						x += 1
+						continue
+
+					# Extend it, tolerating small unchanged gaps
+					x0 = x1 = x
+					while x < self.n_cols:
+						if row_s[x] != row_h[x]:
+							x1 = x
+						elif (x - x1) > self.RUN_GAP:
+							break
+						x += 1
+
+					# Send it
+					self.tc.bus_write_burst(self.tc.SCREEN_BASE | (y << 8) | x0, row_s[x0:x1+1])
+					row_h[x0:x1+1] = row_s[x0:x1+1]
+
+			if self.org != self.hw_org:
+				self.tc.set_origin(0, self.org)
+				self.hw_org = self.org
+
+		self.dirty.clear()
+
+
+def main():
+	# Parse options
+	parser = argparse.ArgumentParser(
+		description='Renders stdin on the text mode display as a VT100 subset terminal',
+		formatter_class=argparse.ArgumentDefaultsHelpFormatter
+	)
+	g_term  = parser.add_argument_group('term',  'Terminal options')
+	g_brd   = parser.add_argument_group('board', 'Board configuration options')
+
+	g_term.add_argument('--font',     type=str, metavar='FILE', help='Font image or pre-converted blob (see mkfont.py)')
+	g_term.add_argument('--no-init',  help='Skip palette / font init', action='store_true', default=False)
+	g_term.add_argument('--interval', type=float, metavar='S', help='Max time between screen updates', default=0.02)
+
+	control.arg_group_setup(g_brd)
+
+	args = parser.parse_args()
+
+	# Build control object with those params
+	kwargs = control.arg_to_kwargs(args)
+
+	tc = text.TextControl(**kwargs)
+
+	if not args.no_init:
+		with tc.batch():
+			text.default_config(tc, args.font)
+
+	term = TextTerminal(tc)
+	term.flush()
+
+	# Render input, flushing at most every 'interval'
+	fd = sys.stdin.fileno()
+	tf = None
+
+	while True:
+		to = None if tf is None else max(tf - time.monotonic(), 0)
+		r, _, _ = select.select([fd], [], [], to)
+
+		if r:
+			data = os.read(fd, 4096)
+			if not data:
+				break
+			term.write(data.decode('latin-1'))
+			if tf is None:
+				tf = time.monotonic() + args.interval
+
+		if (tf is not None) and (time.monotonic() >= tf):
+			term.flush()
+			tf = None
+
+	term.flush()
+
+
+if __name__ == '__main__':
+	main()
@@ -1,90 +1,172 @@
 #!/usr/bin/env python3
 
 import argparse
+import os
 import struct
-from PIL import Image
 
 import control
 
 
+# Video modes
+#  name: (pixel clock, (H FP, Sync, BP, Active), (V FP, Sync, BP, Active))
+VIDEO_MODES = {
+	'1080p60':  (148.5e6,  (  88,  44, 148, 1920), ( 4, 5, 36, 1080)),
+	'1080p50':  (148.5e6,  ( 528,  44, 148, 1920), ( 4, 5, 36, 1080)),
+	'1080p30':  ( 74.25e6, (  88,  44, 148, 1920), ( 4, 5, 36, 1080)),
+	'1080p25':  ( 74.25e6, ( 528,  44, 148, 1920), ( 4, 5, 36, 1080)),
+	'1080p24':  ( 74.25e6, ( 638,  44, 148, 1920), ( 4, 5, 36, 1080)),
+	'720p60':   ( 74.25e6, ( 110,  40, 220, 1280), ( 5, 5, 20,  720)),
+	'720p50':   ( 74.25e6, ( 440,  40, 220, 1280), ( 5, 5, 20,  720)),
+	'1024x768': ( 65.0e6,  (  24, 136, 160, 1024), ( 3, 6, 29,  768)),
+	'640x480':  ( 25.175e6,(  16,  96,  48,  640), (10, 2, 33,  480)),
+}
+
+
 class TextControl(control.BoardControlBase):
 
+	LINE_BASE   = 0x4000
+	ORIGIN_X    = 0x4100
+	ORIGIN_Y    = 0x4101
+	TGEN_BASE   = 0x4110
+	TGEN_COMMIT = 0x4118
 	COLOR_BASE  = 0x6000
 	SCREEN_BASE = 0x8000
 	GLYPH_BASE  = 0xc000
 
+	BRIDGE_FIFO = 256	# Words
+
 	def __init__(self, **kwargs):
 		# Super call
 		super().__init__(**kwargs)
 
+		# Color memory words possibly still queued in the bridge
+		self._color_pending = 0
+
+	def _is_color(self, addr, n):
+		return (addr < self.SCREEN_BASE) and ((addr + n) > self.COLOR_BASE)
+
+	def _color_pace(self, addr, n):
+		# Color memory writes only complete during blanking (a few tens
+		# per line), so don't send more than the bridge FIFO can hold
+		# without giving it time to drain (1 ms is dozens of lines in
+		# any mode)
+		if not self._is_color(addr, n):
+			return
+
+		if (self._color_pending + n) > self.BRIDGE_FIFO:
+			self.spi_idle(1e-3)
+			self._color_pending = 0
+
+		self._color_pending += n
+
 	def bus_write(self, addr, data):
-		self.slave.exchange(struct.pack('>BHH', 0, addr, data))
+		self._color_pace(addr, 1)
+		self.spi_write(struct.pack('>BHH', 0, addr, data))
+
+	def bus_write_burst(self, addr, data):
+		self.bus_write_blob(addr, struct.pack('>%dH' % len(data), *data))
+
+	def bus_write_blob(self, addr, blob, chunk=16384):
+		# Auto-increment burst of big endian words, split to keep each
+		# transaction reasonable (and to fit the bridge FIFO when they
+		# hit color memory)
+		if self._is_color(addr, len(blob) // 2):
+			chunk = min(chunk, 2 * self.BRIDGE_FIFO)
+
+		for i in range(0, len(blob), chunk):
+			a = addr + i // 2
+			d = blob[i:i+chunk]
+			self._color_pace(a, len(d) // 2)
+			self.spi_write(struct.pack('>BH', 1, a) + d)
+
+	def set_origin(self, x=0, y=0):
+		self.bus_write(self.ORIGIN_X, x & 0xff)
+		self.bus_write(self.ORIGIN_Y, y & 0x3f)
+
+	def set_line_offset(self, row, x=0, y=0, fixed=False):
+		self.bus_write(self.LINE_BASE + row, (0x8000 if fixed else 0) | ((y & 0x3f) << 8) | (x & 0xff))
+
+	def set_timings(self, h, v):
+		# H timings are in pixels, the core generates 2 pixels per clock
+		self.bus_write_burst(self.TGEN_BASE, [x // 2 for x in h] + list(v))
+		self.bus_write(self.TGEN_COMMIT, 0)
+
+	def set_mode(self, name, pix_clk=148.5e6):
+		mode_clk, h, v = VIDEO_MODES[name]
+
+		# The pixel clock is fixed by the bitstream
+		if abs(mode_clk - pix_clk) > (pix_clk * 0.005):
+			raise ValueError('Mode %s requires a %.3f MHz pixel clock, bitstream uses %.3f MHz' % (
+				name, mode_clk / 1e6, pix_clk / 1e6))
+
+		self.set_timings(h, v)
 
 	def upload_font(self, fn, s=0):
-		img = Image.open(fn)
+		# Font image (converted on the fly) or pre-converted blob
+		if fn.lower().endswith('.png'):
+			from PIL import Image
+			import mkfont
+			blob = mkfont.font_to_blob(mkfont.font_from_image(Image.open(fn)))
+		else:
+			with open(fn, 'rb') as fh:
+				blob = fh.read(0x4000)
 
-		for i in range(0x0000, 0x2000):
-			c = (i >> 5)
-			fx = (c & 0xf) * 9
-			fy = ((c >> 4) & 0xf) * 17
-			cx = (i & 0x01) * 4
-			cy = (i & 0x1e) >> 1
+		self.bus_write_blob(self.GLYPH_BASE + s*0x2000, blob)
 
-			data = (
-				((img.getpixel( (fx+cx+0, fy+cy) )[0] >> 7) << 12) |
-				((img.getpixel( (fx+cx+1, fy+cy) )[0] >> 7) <<  8) |
-				((img.getpixel( (fx+cx+2, fy+cy) )[0] >> 7) <<  4) |
-				((img.getpixel( (fx+cx+3, fy+cy) )[0] >> 7) <<  0)
-			)
 
-			self.bus_write(self.GLYPH_BASE + s*0x2000 + i, data)
+def default_font():
+	# Use the pre-converted font if it was built, else the image
+	fn = '../data/VGA-8x16'
+	return (fn + '.fnt') if os.path.exists(fn + '.fnt') else (fn + '.png')
 
 
-def default_config(text):
+def default_config(text, font=None):
 	# Colors
 		# FG
-	for i in range(0x6000, 0x6008):
-		text.bus_write(i, (i & 0x7) | ((i & 0x7) << 4))
+	text.bus_write_burst(0x6000, [(i & 0x7) | ((i & 0x7) << 4) for i in range(0x6000, 0x6008)])
 
 		# BG
-	for i in range(0x6008, 0x6010):
-		text.bus_write(i, (i & 0x7) | ((i & 0x7) << 4) | 0x88)
+	text.bus_write_burst(0x6008, [(i & 0x7) | ((i & 0x7) << 4) | 0x88 for i in range(0x6008, 0x6010)])
 
 		# Custom RGBI
-	for i in range(0x6020, 0x6030):
-		text.bus_write(i, (i & 0xf) | ((i & 0xf) << 4))
+	text.bus_write_burst(0x6020, [(i & 0xf) | ((i & 0xf) << 4) for i in range(0x6020, 0x6030)])
+
+	# Scroll origin / Line table
+	text.set_origin(0, 0)
+	text.bus_write_burst(text.LINE_BASE, [0] * 64)
 
 	# Font
-	text.upload_font('../data/VGA-8x16.png')
+	text.upload_font(font or default_font())
 
 
 def show_font(text):
 	# Char matrix
-	for i in range(0x0000, 0x4000):
-		text.bus_write(text.SCREEN_BASE + i,
-			(i & 0xff) |
-			(((i >> 8) & 0x3f) << 10) |
-			(1 << 9)
-		)
+	text.bus_write_burst(text.SCREEN_BASE, [
+		(i & 0xff) |
+		(((i >> 8) & 0x3f) << 10) |
+		(1 << 9)
+		for i in range(0x0000, 0x4000)
+	])
 
 
 def show_bars(text):
 	# Create a font
+	glyphs = []
 	for i in range(16):
 		d = (i << 0) | (i << 4) | (i << 8) | (i << 12)
-		for w in range(32):
-			text.bus_write(text.GLYPH_BASE + 0x2000 + i*32 + w, d)
+		glyphs.extend([d] * 32)
+
+	text.bus_write_burst(text.GLYPH_BASE + 0x2000, glyphs)
 
 	# Bands on the screen
-	for y in range(64):
-		for x in range(256):
-			addr = text.SCREEN_BASE | (y << 8) | x
+	line = [
+		((x >> 3) & 0xf) |
+		(1 <<  8) |
+		(2 << 12)
+		for x in range(256)
+	]
 
-			text.bus_write(addr,
-				((x >> 3) & 0xf) |
-				(1 <<  8) |
-				(2 << 12)
-			)
+	text.bus_write_burst(text.SCREEN_BASE, line * 64)
 
 
 def main():
@@ -95,6 +177,9 @@ def main():
 	g_text  = parser.add_argument_group('test',  'Text core options')
 	g_brd   = parser.add_argument_group('board', 'Board configuration options')
 
+	g_text.add_argument('--font',      type=str, metavar='FILE', help='Font image or pre-converted blob (see mkfont.py)')
+	g_text.add_argument('--mode',      type=str, help='Video mode', choices=sorted(VIDEO_MODES.keys()))
+	g_text.add_argument('--pix-clk',   type=float, metavar='MHZ', help='Bitstream pixel clock', default=148.5)
 	g_text.add_argument('--show-font', help='Show font over FG/BG palette', action='store_true', default=False)
 	g_text.add_argument('--show-bars', help='Show color bars', action='store_true', default=False)
 
@@ -108,13 +193,17 @@ def main():
 	text = TextControl(**kwargs)
 
 	# Commands
-	default_config(text)
+	with text.batch():
+		if args.mode:
+			text.set_mode(args.mode, args.pix_clk * 1e6)
+
+		default_config(text, args.font)
 
-	if args.show_font:
-		show_font(text)
+		if args.show_font:
+			show_font(text)
 
-	if args.show_bars:
-		show_bars(text)
+		if args.show_bars:
+			show_bars(text)
 
 
 if __name__ == '__main__':
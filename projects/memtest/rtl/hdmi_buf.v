@@ -11,13 +11,13 @@
 
 module hdmi_buf (
 	// Write port
-	input  wire [ 8:0] waddr,
+	input  wire [ 9:0] waddr,
 	input  wire [31:0] wdata,
 	input  wire        wren,
 
 	// Read port
 	input  wire [ 9:0] raddr,
-	output wire [15:0] rdata,
+	output wire [31:0] rdata,
 
 	// Clock
 	input  wire clk
@@ -26,14 +26,14 @@ module hdmi_buf (
 	genvar i;
 
 	generate
-		for (i=0; i<4; i=i+1)
+		for (i=0; i<8; i=i+1)
 			ice40_ebr #(
 				.READ_MODE  (2),	// 1024x4
-				.WRITE_MODE (1)		//  512x8
+				.WRITE_MODE (2)		// 1024x4
 			) ebr_wrap_I (
 				.wr_addr (waddr),
-				.wr_data ({wdata[i*4+:4], wdata[16+i*4+:4]}),
-				.wr_mask (8'h00),
+				.wr_data (wdata[i*4+:4]),
+				.wr_mask (4'h0),
 				.wr_ena  (wren),
 				.wr_clk  (clk),
 				.rd_addr (raddr),
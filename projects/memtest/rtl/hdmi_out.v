@@ -10,7 +10,7 @@
 `default_nettype none
 
 module hdmi_out #(
-	parameter integer DW = 4,
+	parameter integer DW = 4
 )(
 	// HDMI pads
 	output wire [DW-1:0] hdmi_data,
@@ -37,7 +37,7 @@ module hdmi_out #(
 	// Wishbone interface
 	input  wire [31:0] wb_wdata,
 	output wire [31:0] wb_rdata,
-	input  wire [ 6:0] wb_addr,
+	input  wire [ 8:0] wb_addr,
 	input  wire        wb_we,
 	input  wire        wb_cyc,
 	output reg         wb_ack,
@@ -51,6 +51,40 @@ module hdmi_out #(
 
 	genvar i;
 
+	// Register map
+	// ------------
+	//
+	// 0x000 : DMA config  [31] run, [30:24] bursts per line - 1,
+	//                     [22:16] burst len - 1, [14:8] last burst len - 1,
+	//                     [7:0] increment after last burst - 1
+	// 0x001 : Frame buffer base address (reloaded at each frame start,
+	//         writing it also restarts the DMA from it right away)
+	// 0x002 : Format      [1:0] 0=4bpp indexed, 1=8bpp indexed, 2=tiles
+	// 0x003 : Underflow   R [31:16] frames with underflows, [15:0] frames
+	//                     W clears both counters
+	// 0x004 : Underflow   R lines that underflowed in the last frame
+	// 0x1xx : Palette
+	//
+	// A line underflows when its DMA isn't complete by the time it starts
+	// being displayed.
+	//
+	// Palette is indexed by {frame[1:0], color[3:0]} in 4bpp / tiles
+	// modes (for temporal dithering) and directly by color in 8bpp mode.
+	//
+	// Tiles are 16 bits words (first one in the MSBs of the memory word),
+	// each describing a group of 4 pixels that's repeated 'rep'+1 times :
+	//
+	//   [15:12] c0, [11:8] c1, [7:4] mask (bit 7 = 1st pixel), [3:0] rep
+	//
+	// with each pixel being c1 if its mask bit is set and c0 otherwise.
+	// A line is complete once 1920 pixels are decoded, each line gets
+	// its fixed size slot (set by the DMA config) in memory.
+
+	localparam [1:0]
+		FMT_4BPP = 2'd0,
+		FMT_8BPP = 2'd1,
+		FMT_TILE = 2'd2;
+
 
 	// Signals
 	// -------
@@ -71,6 +105,8 @@ module hdmi_out #(
 	reg  [ 6:0] dma_cfg_bn_len;
 	reg  [ 6:0] dma_cfg_bl_len;
 	reg  [ 7:0] dma_cfg_bl_inc;
+	reg         dma_base_wr;
+	reg  [ 1:0] fmt;
 
 	reg         dma_run;
 
@@ -80,21 +116,42 @@ module hdmi_out #(
 	reg         dma_last;
 	wire        dma_valid;
 
+	// Underflow monitor
+	reg  [ 9:0] uf_pend;
+	wire        uf_line;
+	reg  [15:0] uf_cur;
+	reg  [15:0] uf_last;
+	reg  [15:0] uf_frames;
+	reg  [15:0] uf_frames_bad;
+	reg         uf_clear;
+
 	// Video Buffer
 	reg         vb_pingpong;
-	reg  [ 7:0] vb_waddr;
+	reg  [ 8:0] vb_waddr;
 	wire [31:0] vb_wdata;
 	wire        vb_wren;
-	reg  [ 8:0] vb_raddr;
-	wire [15:0] vb_rdata;
+	reg  [ 9:0] vb_rptr;
+	wire [ 9:0] vb_rptr_nxt;
+	wire [ 9:0] vb_raddr;
+	wire [31:0] vb_rdata;
+	reg         vb_rhalf;
+	wire [15:0] vb_rdata16;
+
+	// Tile decoder
+	reg         td_active;
+	reg  [15:0] td_tile;
+	reg  [ 3:0] td_cnt;
+	wire        td_next;
 
 	// Palette
 	wire [DW-1:0] pal_wdata;
-	wire [   5:0] pal_waddr;
+	wire [   7:0] pal_waddr;
 	reg           pal_wren;
 
 	// Video Out
 	reg  [   1:0] frame_cnt;
+	reg  [  31:0] px_data;
+	wire [   7:0] px_idx[0:3];
 
 	wire [DW-1:0] vo_data[0:3];
 	wire          vo_hsync;
@@ -118,27 +175,39 @@ module hdmi_out #(
 			dma_cfg_bn_len <= 0;
 			dma_cfg_bl_len <= 0;
 			dma_cfg_bl_inc <= 0;
-		end else if (wb_cyc & ~wb_ack & ~wb_addr[6]) begin
-			if (wb_addr[0])
-				dma_cfg_base <= wb_wdata;
-			else begin
-				dma_run        <= wb_wdata[31];
-				dma_cfg_bn_cnt <= wb_wdata[30:24];
-				dma_cfg_bn_len <= wb_wdata[22:16];
-				dma_cfg_bl_len <= wb_wdata[14: 8];
-				dma_cfg_bl_inc <= wb_wdata[ 7: 0];
-			end
+			fmt            <= FMT_4BPP;
+		end else if (wb_cyc & ~wb_ack & wb_we & ~wb_addr[8]) begin
+			case (wb_addr[2:0])
+				3'h0: begin
+					dma_run        <= wb_wdata[31];
+					dma_cfg_bn_cnt <= wb_wdata[30:24];
+					dma_cfg_bn_len <= wb_wdata[22:16];
+					dma_cfg_bl_len <= wb_wdata[14: 8];
+					dma_cfg_bl_inc <= wb_wdata[ 7: 0];
+				end
+				3'h1: dma_cfg_base <= wb_wdata;
+				3'h2: fmt <= wb_wdata[1:0];
+			endcase
 		end
 
+	always @(posedge clk_1x)
+		dma_base_wr <= wb_cyc & ~wb_ack & wb_we & ~wb_addr[8] & (wb_addr[2:0] == 3'h1);
+
+	always @(posedge clk_1x)
+		uf_clear <= wb_cyc & ~wb_ack & wb_we & ~wb_addr[8] & (wb_addr[2:0] == 3'h3);
+
 	// Palette write
 	assign pal_wdata = wb_wdata[DW-1:0];
-	assign pal_waddr = wb_addr[5:0];
+	assign pal_waddr = wb_addr[7:0];
 
 	always @(posedge clk_1x)
-		pal_wren <= wb_cyc & ~wb_ack & wb_addr[6];
+		pal_wren <= wb_cyc & ~wb_ack & wb_we & wb_addr[8];
 
-	// No read support
-	assign wb_rdata = 32'h00000000;
+	// Read Mux
+	assign wb_rdata = ~wb_ack ? 32'h00000000 :
+		(wb_addr[2:0] == 3'h3) ? { uf_frames_bad, uf_frames } :
+		(wb_addr[2:0] == 3'h4) ? { 16'h0000, uf_last } :
+		32'h00000000;
 
 
 	// Timing generator
@@ -194,7 +263,7 @@ module hdmi_out #(
 	assign dma_valid = dma_cnt[7];
 
 	always @(posedge clk_1x)
-		if (vt_trig & vt_vlast)
+		if ((vt_trig & vt_vlast) | dma_base_wr)
 			dma_addr <= dma_cfg_base;
 		else if (mi_ready & mi_valid)
 			dma_addr <= dma_addr + (dma_last ? dma_cfg_bl_inc : dma_cfg_bn_len) + 1;
@@ -207,10 +276,41 @@ module hdmi_out #(
 
 	assign mi_wdata = 32'hxxxxxxxx;
 
+	// Underflow monitor
+		// Count words requested but not received yet (not all memory
+		// controllers provide mi_rlast). A word arriving right as the
+		// line starts is still in time.
+	always @(posedge clk_1x)
+		if (rst)
+			uf_pend <= 10'h000;
+		else
+			uf_pend <= uf_pend + ((mi_ready & mi_valid) ? (mi_len + 1) : 0) - mi_rstb;
+
+	assign uf_line = vt_trig & dma_run & (dma_valid | (uf_pend > { 9'h000, mi_rstb }));
+
+	always @(posedge clk_1x)
+		if (rst | uf_clear)
+			uf_cur <= 16'h0000;
+		else if (vt_trig & vt_vfirst)
+			uf_cur <= uf_line;
+		else
+			uf_cur <= uf_cur + uf_line;
+
+	always @(posedge clk_1x)
+		if (rst | uf_clear) begin
+			uf_last       <= 16'h0000;
+			uf_frames     <= 16'h0000;
+			uf_frames_bad <= 16'h0000;
+		end else if (vt_trig & vt_vfirst) begin
+			uf_last       <= uf_cur;
+			uf_frames     <= uf_frames + 1;
+			uf_frames_bad <= uf_frames_bad + (uf_cur != 16'h0000);
+		end
+
 	// Buffer write path
 	always @(posedge clk_1x)
 		if (vt_trig)
-			vb_waddr <= 8'h00;
+			vb_waddr <= 9'h000;
 		else
 			vb_waddr <= vb_waddr + mi_rstb;
 
@@ -233,7 +333,7 @@ module hdmi_out #(
 		.waddr ({vb_pingpong, vb_waddr}),
 		.wdata (vb_wdata),
 		.wren  (vb_wren),
-		.raddr ({~vb_pingpong, vb_raddr}),
+		.raddr (vb_raddr),
 		.rdata (vb_rdata),
 		.clk   (clk_1x)
 	);
@@ -248,27 +348,70 @@ module hdmi_out #(
 			frame_cnt <= frame_cnt + 1;
 
 	// Buffer read
+		// The pointer is in 16 bits units (32 bits in 8bpp mode) and the
+		// next value is fed directly to the memory so the tile decoder
+		// can fetch a new tile every cycle. Data for group N is out of
+		// the memory at trig + 1 + N (4bpp / 8bpp)
+	assign vb_rptr_nxt = vt_trig ? 10'h000 : (vb_rptr + ((fmt == FMT_TILE) ? td_next : vt_de));
+
+	always @(posedge clk_1x)
+		vb_rptr <= vb_rptr_nxt;
+
+	assign vb_raddr = {
+		~(vb_pingpong ^ vt_trig),
+		(fmt == FMT_8BPP) ? vb_rptr_nxt[8:0] : vb_rptr_nxt[9:1]
+	};
+
+	always @(posedge clk_1x)
+		vb_rhalf <= vb_rptr_nxt[0];
+
+	assign vb_rdata16 = vb_rhalf ? vb_rdata[15:0] : vb_rdata[31:16];
+
+	// Tile decoder
+		// Tile for group N is in td_tile at trig + 2 + N
+	always @(posedge clk_1x)
+		td_active <= vt_de;
+
+	assign td_next = td_active & (td_cnt == 4'h0);
+
 	always @(posedge clk_1x)
 		if (vt_trig)
-			vb_raddr <= 9'h000;
-		else
-			vb_raddr <= vb_raddr + vt_de;
+			td_cnt <= 4'h0;
+		else if (td_next)
+			td_cnt <= vb_rdata16[3:0];
+		else if (td_active)
+			td_cnt <= td_cnt - 1;
+
+	always @(posedge clk_1x)
+		if (td_next)
+			td_tile <= vb_rdata16;
+
+	// Pixel data (at trig + 2 + N)
+	always @(posedge clk_1x)
+		px_data <= (fmt == FMT_8BPP) ? vb_rdata : { vb_rdata16, 16'h0000 };
 
 	// Palette lookup
 	generate
 		for (i=0; i<4; i=i+1)
+		begin
+			assign px_idx[i] =
+				(fmt == FMT_8BPP) ? px_data[(3-i)*8+:8] :
+				(fmt == FMT_TILE) ? { 2'b00, frame_cnt, td_tile[7-i] ? td_tile[11:8] : td_tile[15:12] } :
+				                    { 2'b00, frame_cnt, px_data[(7-i)*4+:4] };
+
 			ram_sdp #(
-				.AWIDTH(6),
+				.AWIDTH(8),
 				.DWIDTH(DW)
 			) pal_I (
 				.wr_addr (pal_waddr),
 				.wr_data (pal_wdata),
 				.wr_ena  (pal_wren),
-				.rd_addr ({frame_cnt, vb_rdata[(3-i)*4+:4]}),
+				.rd_addr (px_idx[i]),
 				.rd_data (vo_data[i]),
 				.rd_ena  (1'b1),
 				.clk     (clk_1x)
 			);
+		end
 	endgenerate
 
 	// Control delay
@@ -42,6 +42,43 @@ module memtest #(
 	input  wire rst
 );
 
+	// Register map
+	// ------------
+	//
+	// 0x000 : CMD / Status
+	//          W [23]    Run: repeat the burst 'Run count' + 1 times
+	//            [22]    Invert generated pattern
+	//            [21:19] Pattern: 0=buffer, 1=PRBS, 2=address, 3=walking one
+	//            [18]    Dual (two consecutive bursts)
+	//            [17]    Reset checker state
+	//            [16]    Read (1) / Write (0)
+	//            [15:8]  Buffer address
+	//            [6:0]   Length - 1
+	//          R [2]     Busy: command pending or data outstanding, once
+	//                    clear all checks and counters are final
+	//            [1]     All data checked OK since last reset
+	//            [0]     Memory interface ready
+	// 0x001 : Address           (W)
+	// 0x002 : Pattern seed      (RW)
+	// 0x003 : Error count       (R)  Words that failed checking
+	// 0x004 : First error addr  (R)  Address of the first failed word
+	// 0x005 : Run count         (W)  Number of bursts - 1 for a run
+	// 0x008 : Busy cycles       (R)  Command pending or data outstanding
+	//                           (W)  Any write clears all the counters
+	// 0x009 : Stall cycles      (R)  mi_valid & ~mi_ready
+	// 0x00a : Words             (R)  Data words transferred
+	// 0x00b : Bursts            (R)  Requests accepted
+	// 0x00c : Latency sum       (R)  Request to first word, summed
+	// 0x00d : Latency count     (R)  Number of requests in the sum
+	//                                (only those issued with no data
+	//                                 outstanding are measured)
+	// 0x1xx : Buffer            (W: data to write, R: data read)
+	//
+	// The generated patterns are a function of the word address and seed
+	// only, so the data is unique for every address and the same data
+	// can be checked back using any burst length / alignment.
+	//
+
 	// Signals
 	// -------
 
@@ -63,9 +100,13 @@ module memtest #(
 	wire        br_rden;
 
 	// Wishbone
-	reg wb_ack_i;
-	reg wb_we_cmd;
-	reg wb_we_addr;
+	reg  wb_ack_i;
+	reg  wb_we_cmd;
+	reg  wb_we_addr;
+	reg  wb_we_seed;
+	reg  wb_we_run;
+	reg  wb_we_perf;
+	wire [31:0] wb_rdata_csr;
 
 	// Commands
 	reg         cmd_valid;
@@ -74,9 +115,43 @@ module memtest #(
 	reg  [ 6:0] cmd_len;
 	reg  [AL:0] cmd_addr;
 	reg         cmd_dual;
+	reg  [ 2:0] cmd_pat;
+	reg         cmd_inv;
+	reg  [23:0] run_len;
+	reg  [23:0] run_cnt;
+	wire        run_more;
+	wire        busy;
+
+	// Pattern generator
+	reg  [31:0] pg_seed;
+	reg  [AL:0] pg_cur;
+	reg  [AL:0] pg_nxt;
+	wire        pg_step;
+	wire [31:0] pg_src;
+	wire [31:0] pg_x0;
+	wire [31:0] pg_x1;
+	wire [31:0] pg_x2;
+	wire [31:0] pg_x3;
+	reg  [31:0] pg_gen;
+	reg  [31:0] pg_data;
+
+	// Performance counters
+	wire        pf_accept;
+	reg  [15:0] pf_pend;
+	reg         pf_lat_active;
+	reg  [31:0] pf_busy;
+	reg  [31:0] pf_stall;
+	reg  [31:0] pf_words;
+	reg  [31:0] pf_bursts;
+	reg  [31:0] pf_lat_sum;
+	reg  [31:0] pf_lat_n;
 
 	// Validate
-	reg val_ok;
+	wire [31:0] val_ref;
+	wire        val_err;
+	reg         val_ok;
+	reg  [31:0] val_err_cnt;
+	reg  [AL:0] val_err_addr;
 
 
 	// Buffers
@@ -120,7 +195,20 @@ module memtest #(
 
 	// Read Mux
 	assign wb_rdata = wb_ack_i ?
-		(wb_addr[8] ? br_rdata : { 30'h00000000, val_ok, mi_ready }) :
+		(wb_addr[8] ? br_rdata : wb_rdata_csr) :
+		32'h00000000;
+
+	assign wb_rdata_csr =
+		(wb_addr[3:0] == 4'h0) ? { 29'h00000000, busy, val_ok, mi_ready } :
+		(wb_addr[3:0] == 4'h2) ? pg_seed :
+		(wb_addr[3:0] == 4'h3) ? val_err_cnt :
+		(wb_addr[3:0] == 4'h4) ? val_err_addr :
+		(wb_addr[3:0] == 4'h8) ? pf_busy :
+		(wb_addr[3:0] == 4'h9) ? pf_stall :
+		(wb_addr[3:0] == 4'ha) ? pf_words :
+		(wb_addr[3:0] == 4'hb) ? pf_bursts :
+		(wb_addr[3:0] == 4'hc) ? pf_lat_sum :
+		(wb_addr[3:0] == 4'hd) ? pf_lat_n :
 		32'h00000000;
 
 	// Buffer accesses
@@ -136,9 +224,15 @@ module memtest #(
 		if (wb_ack_i) begin
 			wb_we_cmd  <= 1'b0;
 			wb_we_addr <= 1'b0;
+			wb_we_seed <= 1'b0;
+			wb_we_run  <= 1'b0;
+			wb_we_perf <= 1'b0;
 		end else begin
-			wb_we_cmd  <= wb_cyc & wb_we & ~wb_addr[8] & ~wb_addr[0];
-			wb_we_addr <= wb_cyc & wb_we & ~wb_addr[8] &  wb_addr[0];
+			wb_we_cmd  <= wb_cyc & wb_we & ~wb_addr[8] & (wb_addr[3:0] == 4'h0);
+			wb_we_addr <= wb_cyc & wb_we & ~wb_addr[8] & (wb_addr[3:0] == 4'h1);
+			wb_we_seed <= wb_cyc & wb_we & ~wb_addr[8] & (wb_addr[3:0] == 4'h2);
+			wb_we_run  <= wb_cyc & wb_we & ~wb_addr[8] & (wb_addr[3:0] == 4'h5);
+			wb_we_perf <= wb_cyc & wb_we & ~wb_addr[8] & (wb_addr[3:0] == 4'h8);
 		end
 
 	always @(posedge clk)
@@ -148,7 +242,7 @@ module memtest #(
 		if (rst)
 			cmd_valid <= 1'b0;
 		else
-			cmd_valid <= (cmd_valid & (~mi_ready | cmd_dual)) | cmd_start;
+			cmd_valid <= (cmd_valid & (~mi_ready | cmd_dual | run_more)) | cmd_start;
 
 	always @(posedge clk)
 		if (wb_we_cmd)
@@ -156,8 +250,22 @@ module memtest #(
 		else if (mi_ready & mi_valid)
 			cmd_dual <= 1'b0;
 
+	always @(posedge clk)
+		if (wb_we_run)
+			run_len <= wb_wdata[23:0];
+
+	always @(posedge clk)
+		if (wb_we_cmd)
+			run_cnt <= wb_wdata[23] ? run_len : 24'h000000;
+		else if (mi_ready & mi_valid & ~cmd_dual & run_more)
+			run_cnt <= run_cnt - 1;
+
+	assign run_more = (run_cnt != 24'h000000);
+
 	always @(posedge clk)
 		if (wb_we_cmd) begin
+			cmd_inv  <= wb_wdata[   22];
+			cmd_pat  <= wb_wdata[21:19];
 			cmd_read <= wb_wdata[   16];
 			cmd_len  <= wb_wdata[ 6: 0];
 		end
@@ -185,7 +293,7 @@ module memtest #(
 		else
 			bw_raddr <= bw_raddr + bw_rden;
 
-	assign mi_wdata = bw_rdata;
+	assign mi_wdata = (cmd_pat == 3'd0) ? bw_rdata : pg_data;
 	assign mi_wmsk  = 4'h0;
 
 	assign bw_rden = (cmd_read ? mi_rstb : mi_wack) | cmd_start;
@@ -201,10 +309,106 @@ module memtest #(
 			br_waddr <= br_waddr + mi_rstb;
 
 	// Data validation
+	assign val_ref = (cmd_pat == 3'd0) ? bw_rdata : pg_data;
+	assign val_err = mi_rstb & (mi_rdata != val_ref);
+
 	always @(posedge clk)
 		if (wb_we_cmd)
 			val_ok <= val_ok | wb_wdata[17];
 		else
-			val_ok <= val_ok & (~mi_rstb | (mi_rdata == bw_rdata));
+			val_ok <= val_ok & ~val_err;
+
+	always @(posedge clk)
+		if (wb_we_cmd & wb_wdata[17])
+			val_err_cnt <= 0;
+		else
+			val_err_cnt <= val_err_cnt + val_err;
+
+	always @(posedge clk)
+		if (val_err & (val_err_cnt == 0))
+			val_err_addr <= pg_cur;
+
+
+	// Pattern generator
+	// -----------------
+
+	// Seed
+	always @(posedge clk)
+		if (wb_we_seed)
+			pg_seed <= wb_wdata;
+
+	// Word address tracking
+	assign pg_step = cmd_read ? mi_rstb : mi_wack;
+
+	always @(posedge clk)
+		if (cmd_start) begin
+			pg_cur <= cmd_addr;
+			pg_nxt <= cmd_addr + 1;
+		end else if (pg_step) begin
+			pg_cur <= pg_nxt;
+			pg_nxt <= pg_nxt + 1;
+		end
+
+	// Generator (for the address about to become current)
+	assign pg_src = cmd_start ? cmd_addr : pg_nxt;
+
+		// PRBS: xorshift32 of address and seed (bijective so unique)
+	assign pg_x0 = pg_src ^ pg_seed;
+	assign pg_x1 = pg_x0 ^ (pg_x0 << 13);
+	assign pg_x2 = pg_x1 ^ (pg_x1 >> 17);
+	assign pg_x3 = pg_x2 ^ (pg_x2 <<  5);
+
+	always @(*)
+		case (cmd_pat)
+			3'd1:    pg_gen = pg_x3;
+			3'd2:    pg_gen = pg_x0;
+			3'd3:    pg_gen = 32'h00000001 << (pg_src[4:0] + pg_seed[4:0]);
+			default: pg_gen = 32'hxxxxxxxx;
+		endcase
+
+	always @(posedge clk)
+		if (cmd_start | pg_step)
+			pg_data <= cmd_inv ? ~pg_gen : pg_gen;
+
+
+	// Performance counters
+	// --------------------
+
+	assign pf_accept = mi_valid & mi_ready;
+
+	// Outstanding data words
+	always @(posedge clk)
+		if (rst)
+			pf_pend <= 0;
+		else
+			pf_pend <= pf_pend + (pf_accept ? (mi_len + 1) : 0) - pg_step;
+
+	// First word latency measurement in progress
+	always @(posedge clk)
+		if (rst)
+			pf_lat_active <= 1'b0;
+		else
+			pf_lat_active <= (pf_lat_active & ~pg_step) | (pf_accept & (pf_pend == 0));
+
+	// Busy (from the command write until the last data word)
+	assign busy = wb_we_cmd | cmd_start | cmd_valid | (pf_pend != 0);
+
+	// Counters
+	always @(posedge clk)
+		if (wb_we_perf) begin
+			pf_busy    <= 0;
+			pf_stall   <= 0;
+			pf_words   <= 0;
+			pf_bursts  <= 0;
+			pf_lat_sum <= 0;
+			pf_lat_n   <= 0;
+		end else begin
+			pf_busy    <= pf_busy    + (cmd_valid | (pf_pend != 0));
+			pf_stall   <= pf_stall   + (mi_valid & ~mi_ready);
+			pf_words   <= pf_words   + pg_step;
+			pf_bursts  <= pf_bursts  + pf_accept;
+			pf_lat_sum <= pf_lat_sum + pf_lat_active;
+			pf_lat_n   <= pf_lat_n   + (pf_accept & (pf_pend == 0));
+		end
 
 endmodule
@@ -143,7 +143,7 @@ module top (
 	// --------------
 
 `ifdef HAS_UART
-	uart2wb #(
+	uart2wb_blk #(
 		.UART_DIV($rtoi((`SYS_FREQ / BAUDRATE) + 0.5)),
 `elsif HAS_USB
 	muacm2wb #(
@@ -453,7 +453,7 @@ module top (
 		.hdmi_clk   (hdmi_clk),
 		.wb_wdata   (wb_wdata),
 		.wb_rdata   (wb_rdata[95:64]),
-		.wb_addr    (wb_addr[6:0]),
+		.wb_addr    (wb_addr[8:0]),
 		.wb_we      (wb_we),
 		.wb_cyc     (wb_cyc[2]),
 		.wb_ack     (wb_ack[2]),
@@ -0,0 +1,395 @@
+/*
+ * uart2wb_blk.v
+ *
+ * vim: ts=4 sw=4
+ *
+ * Copyright (C) 2020-2021  Sylvain Munaut <tnt@246tNt.com>
+ * SPDX-License-Identifier: CERN-OHL-P-2.0
+ */
+
+`default_nettype none
+
+module uart2wb_blk #(
+	parameter integer UART_DIV = 20,
+	parameter integer WB_N = 3,
+
+	// auto
+	parameter integer DL = (32*WB_N)-1,
+	parameter integer CL = WB_N-1
+)(
+	// UART
+	input  wire        uart_rx,
+	output wire        uart_tx,
+
+	// Wishbone
+	output reg  [31:0] wb_wdata,
+	input  wire [DL:0] wb_rdata,
+	output wire [15:0] wb_addr,
+	output reg         wb_we,
+	output reg  [CL:0] wb_cyc,
+	input  wire [CL:0] wb_ack,
+
+	// Aux CSR
+	output reg  [31:0] aux_csr,
+
+	// Clock / Reset
+	input  wire clk,
+	input  wire rst
+);
+
+	// Protocol
+	// --------
+	//
+	// Same as the uart2wb bridge from no2misc : 5 bytes big endian
+	// commands, [39:36] opcode, [35:0] payload
+	//
+	//  0 SYNC       Single byte, replies 0xcafebabe
+	//  1 REG_ACCESS [20] read, [19:16] slave, [15:0] address
+	//  2 DATA_SET   [31:0] data register
+	//  3 DATA_GET   Replies with the data register
+	//  4 AUX_CSR    [31:0] aux_csr
+	//
+	// And block transfers, [31:20] word count - 1, [19:0] first address
+	//
+	//  5 BLK_WRITE  Followed by 4 bytes per word, written to consecutive
+	//               addresses
+	//  6 BLK_READ   Replies with 4 bytes per word, read from consecutive
+	//               addresses. No command must be sent until all the data
+	//               has been received.
+	//
+	// Accesses to a slave index >= WB_N are acked locally (reads return 0)
+	// so a bad address can't lock up the bridge.
+	//
+
+	localparam [3:0]
+		OP_SYNC       = 4'h0,
+		OP_REG_ACCESS = 4'h1,
+		OP_DATA_SET   = 4'h2,
+		OP_DATA_GET   = 4'h3,
+		OP_AUX_CSR    = 4'h4,
+		OP_BLK_WRITE  = 4'h5,
+		OP_BLK_READ   = 4'h6;
+
+	localparam [2:0]
+		ST_CMD     = 0,
+		ST_WB      = 1,
+		ST_BW_DATA = 2,
+		ST_BW_WB   = 3,
+		ST_BR_WB   = 4,
+		ST_BR_TX   = 5;
+
+
+	// Signals
+	// -------
+
+	// UART RX
+	reg   [2:0] rx_sync;
+	reg         rx_active;
+	reg  [11:0] rx_div_cnt;
+	wire        rx_tick;
+	reg   [3:0] rx_bit_cnt;
+	reg   [7:0] rx_shift;
+	wire        rx_done;
+
+	reg   [7:0] rx_data;
+	reg         rx_pend;
+	wire        rx_ack;
+
+	// UART TX
+	wire        tx_load;
+	wire [31:0] tx_load_data;
+	reg  [31:0] tx_word;
+	reg   [2:0] tx_nbytes;
+	wire        tx_busy;
+	wire        tx_byte_go;
+
+	reg         tx_active;
+	reg  [11:0] tx_div_cnt;
+	wire        tx_tick;
+	reg   [3:0] tx_bit_cnt;
+	reg  [10:0] tx_shift;
+
+	// Command
+	reg   [2:0] state;
+
+	reg  [39:0] cmd_sr;
+	reg   [2:0] cmd_cnt;
+	wire        cmd_cnt_last;
+	wire  [3:0] cmd_op;
+	wire [35:0] cmd_p;
+	wire        cmd_is_sync;
+	wire        cmd_need_tx;
+	reg         cmd_go;
+	reg         sync_go;
+
+	// Wishbone
+	reg  [19:0] addr;
+	reg  [11:0] blk_cnt;
+	reg         blk_end;
+	wire  [3:0] wb_slave;
+	wire        wb_start;
+	reg         wb_nul;
+	wire        wb_ack_any;
+	reg  [31:0] wb_rdata_mux;
+
+
+	// UART RX
+	// -------
+
+	// Input synchronizer
+	always @(posedge clk)
+		rx_sync <= { rx_sync[1:0], uart_rx };
+
+	// Bit timing (sample at the middle of each bit)
+	always @(posedge clk)
+		if (rst)
+			rx_active <= 1'b0;
+		else if (~rx_active)
+			rx_active <= ~rx_sync[2];
+		else if (rx_tick & ((rx_bit_cnt == 4'd0) ? rx_sync[2] : (rx_bit_cnt == 4'd9)))
+			rx_active <= 1'b0;
+
+	always @(posedge clk)
+		if (~rx_active)
+			rx_div_cnt <= (UART_DIV / 2) - 1;
+		else if (rx_tick)
+			rx_div_cnt <= UART_DIV - 1;
+		else
+			rx_div_cnt <= rx_div_cnt - 1;
+
+	assign rx_tick = rx_active & (rx_div_cnt == 0);
+
+	always @(posedge clk)
+		if (~rx_active)
+			rx_bit_cnt <= 4'd0;
+		else
+			rx_bit_cnt <= rx_bit_cnt + rx_tick;
+
+	// Data (LSB first)
+	always @(posedge clk)
+		if (rx_tick & (rx_bit_cnt != 4'd9))
+			rx_shift <= { rx_sync[2], rx_shift[7:1] };
+
+	assign rx_done = rx_tick & (rx_bit_cnt == 4'd9) & rx_sync[2];
+
+	// Holding register, gives one byte time of slack to the command logic
+	always @(posedge clk)
+		if (rx_done)
+			rx_data <= rx_shift;
+
+	always @(posedge clk)
+		if (rst)
+			rx_pend <= 1'b0;
+		else
+			rx_pend <= (rx_pend & ~rx_ack) | rx_done;
+
+
+	// UART TX
+	// -------
+
+	// Word buffer
+	always @(posedge clk)
+		if (rst)
+			tx_nbytes <= 3'd0;
+		else if (tx_load)
+			tx_nbytes <= 3'd4;
+		else if (tx_byte_go)
+			tx_nbytes <= tx_nbytes - 1;
+
+	always @(posedge clk)
+		if (tx_load)
+			tx_word <= tx_load_data;
+		else if (tx_byte_go)
+			tx_word <= { tx_word[23:0], 8'h00 };
+
+	assign tx_busy    = (tx_nbytes != 3'd0);
+	assign tx_byte_go = tx_busy & ~tx_active;
+
+	// Shifter (start, 8 data bits LSB first, 2 stop)
+	always @(posedge clk)
+		if (rst)
+			tx_active <= 1'b0;
+		else if (tx_byte_go)
+			tx_active <= 1'b1;
+		else if (tx_tick & (tx_bit_cnt == 4'd10))
+			tx_active <= 1'b0;
+
+	always @(posedge clk)
+		if (~tx_active | tx_tick)
+			tx_div_cnt <= UART_DIV - 1;
+		else
+			tx_div_cnt <= tx_div_cnt - 1;
+
+	assign tx_tick = tx_active & (tx_div_cnt == 0);
+
+	always @(posedge clk)
+		if (~tx_active)
+			tx_bit_cnt <= 4'd0;
+		else
+			tx_bit_cnt <= tx_bit_cnt + tx_tick;
+
+	always @(posedge clk)
+		if (rst)
+			tx_shift <= 11'h7ff;
+		else if (tx_byte_go)
+			tx_shift <= { 2'b11, tx_word[31:24], 1'b0 };
+		else if (tx_tick)
+			tx_shift <= { 1'b1, tx_shift[10:1] };
+
+	assign uart_tx = tx_shift[0];
+
+	// Load
+	assign tx_load = sync_go | (cmd_go & (cmd_op == OP_DATA_GET)) | ((state == ST_BR_TX) & ~tx_busy);
+	assign tx_load_data = sync_go ? 32'hcafebabe : wb_wdata;
+
+
+	// Command
+	// -------
+
+	// Fields
+	assign cmd_op = cmd_sr[39:36];
+	assign cmd_p  = cmd_sr[35: 0];
+
+	// Byte accept
+	assign cmd_is_sync  = (cmd_cnt == 3'd0) & (rx_data[7:4] == OP_SYNC);
+	assign cmd_need_tx  = cmd_is_sync | ((cmd_cnt == 3'd4) & (cmd_sr[31:28] == OP_DATA_GET));
+	assign cmd_cnt_last = (state == ST_CMD) ? (cmd_cnt == 3'd4) : (cmd_cnt == 3'd3);
+
+	assign rx_ack = rx_pend & (
+		((state == ST_CMD) & ~cmd_go & ~(cmd_need_tx & tx_busy)) |
+		(state == ST_BW_DATA)
+	);
+
+	always @(posedge clk)
+		if (rst)
+			cmd_cnt <= 3'd0;
+		else if (rx_ack)
+			cmd_cnt <= (((state == ST_CMD) & cmd_is_sync) | cmd_cnt_last) ? 3'd0 : (cmd_cnt + 1);
+
+	always @(posedge clk)
+		if (rx_ack & (state == ST_CMD))
+			cmd_sr <= { cmd_sr[31:0], rx_data };
+
+	always @(posedge clk)
+	begin
+		cmd_go  <= rx_ack & (state == ST_CMD) & ~cmd_is_sync & cmd_cnt_last;
+		sync_go <= rx_ack & (state == ST_CMD) &  cmd_is_sync;
+	end
+
+	// State
+	always @(posedge clk)
+		if (rst)
+			state <= ST_CMD;
+		else
+			case (state)
+				ST_CMD:
+					if (cmd_go)
+						case (cmd_op)
+							OP_REG_ACCESS: state <= ST_WB;
+							OP_BLK_WRITE:  state <= ST_BW_DATA;
+							OP_BLK_READ:   state <= ST_BR_WB;
+							default:       state <= ST_CMD;
+						endcase
+
+				ST_WB:
+					if (wb_ack_any)
+						state <= ST_CMD;
+
+				ST_BW_DATA:
+					if (rx_ack & cmd_cnt_last)
+						state <= ST_BW_WB;
+
+				ST_BW_WB:
+					if (wb_ack_any)
+						state <= (blk_cnt == 12'h000) ? ST_CMD : ST_BW_DATA;
+
+				ST_BR_WB:
+					if (wb_ack_any)
+						state <= ST_BR_TX;
+
+				ST_BR_TX:
+					if (~tx_busy)
+						state <= blk_end ? ST_CMD : ST_BR_WB;
+
+				default:
+					state <= ST_CMD;
+			endcase
+
+	// Registers
+	always @(posedge clk)
+		if (rst)
+			aux_csr <= 32'h00000000;
+		else if (cmd_go & (cmd_op == OP_AUX_CSR))
+			aux_csr <= cmd_p[31:0];
+
+
+	// Wishbone
+	// --------
+
+	// Address / Count
+	always @(posedge clk)
+		if (cmd_go) begin
+			addr    <= cmd_p[19:0];
+			blk_cnt <= cmd_p[31:20];
+		end else if (wb_ack_any & (state != ST_WB)) begin
+			addr    <= addr + 1;
+			blk_cnt <= blk_cnt - 1;
+		end
+
+	always @(posedge clk)
+		if (wb_ack_any)
+			blk_end <= (blk_cnt == 12'h000);
+
+	assign wb_addr = addr[15:0];
+
+	// Cycle
+	assign wb_start =
+		(cmd_go & (cmd_op == OP_REG_ACCESS)) |
+		(cmd_go & (cmd_op == OP_BLK_READ)) |
+		((state == ST_BW_DATA) & rx_ack & cmd_cnt_last) |
+		((state == ST_BR_TX) & ~tx_busy & ~blk_end);
+
+	assign wb_slave = (state == ST_CMD) ? cmd_p[19:16] : addr[19:16];
+
+	always @(posedge clk)
+		if (rst)
+			wb_cyc <= 0;
+		else if (wb_ack_any)
+			wb_cyc <= 0;
+		else if (wb_start)
+			wb_cyc <= 1 << wb_slave;
+
+	// Unmapped slave
+	always @(posedge clk)
+		if (rst)
+			wb_nul <= 1'b0;
+		else if (wb_ack_any)
+			wb_nul <= 1'b0;
+		else if (wb_start)
+			wb_nul <= (wb_slave >= WB_N);
+
+	always @(posedge clk)
+		if (wb_start)
+			wb_we <= (state == ST_CMD) ? ((cmd_op == OP_REG_ACCESS) & ~cmd_p[20]) : (state == ST_BW_DATA);
+
+	assign wb_ack_any = |(wb_ack & wb_cyc) | wb_nul;
+
+	// Read data
+	always @(*)
+	begin : rdata_mux
+		integer i;
+		wb_rdata_mux = 32'h00000000;
+		for (i=0; i<WB_N; i=i+1)
+			wb_rdata_mux = wb_rdata_mux | (wb_cyc[i] ? wb_rdata[32*i+:32] : 32'h00000000);
+	end
+
+	// Data register
+	always @(posedge clk)
+		if (cmd_go & (cmd_op == OP_DATA_SET))
+			wb_wdata <= cmd_p[31:0];
+		else if (rx_ack & (state == ST_BW_DATA))
+			wb_wdata <= { wb_wdata[23:0], rx_data };
+		else if (wb_ack_any & ~wb_we)
+			wb_wdata <= wb_rdata_mux;
+
+endmodule // uart2wb_blk
@@ -0,0 +1,198 @@
+/*
+ * hyperram.v
+ *
+ * vim: ts=4 sw=4
+ *
+ * Copyright (C) 2020-2021  Sylvain Munaut <tnt@246tNt.com>
+ * SPDX-License-Identifier: CERN-OHL-P-2.0
+ */
+
+`default_nettype none
+`timescale 1ns / 100ps
+
+//
+// Behavioural model of a HyperRAM chip
+//
+//  - Always in fixed (2x) latency mode, the latency count is taken from
+//    CR0 (LATENCY after reset) and the first data word is transferred
+//    on clock LAT_OFS + 2 * latency (clocks counted from 0, with the
+//    command / address on clocks 0 to 2).
+//  - Register writes have no latency.
+//  - Wrapped bursts are treated as linear, which is equivalent as long
+//    as they start aligned (which is always the case in memtest).
+//  - Address wraps every 2^AW 16 bits words.
+//
+// Outputs are updated T_CO after each clock edge (edge aligned RWDS).
+//
+
+module hyperram #(
+	parameter integer LATENCY = 6,
+	parameter integer LAT_OFS = 1,
+	parameter integer AW = 16,
+	parameter integer T_CO = 1
+)(
+	inout  wire [7:0] dq,
+	inout  wire       rwds,
+	input  wire       ck,
+	input  wire       cs_n,
+	input  wire       rst_n
+);
+
+	// Signals
+	// -------
+
+	reg  [15:0] mem[0:(1<<AW)-1];
+
+	reg  [15:0] cr0;
+	reg  [15:0] cr1;
+	integer     lc;
+
+	reg  [47:0] ca;
+	wire        ca_read;
+	wire        ca_reg;
+
+	reg  [31:0] addr;
+	reg  [15:0] rd_data;
+	reg   [7:0] wr_byte;
+	integer     edge_cnt;
+	integer     data_edge;
+	integer     k;
+
+	reg   [7:0] dq_out;
+	reg         dq_oe;
+	reg         rwds_out;
+	reg         rwds_oe;
+
+
+	// Configuration
+	// -------------
+
+	always @(negedge rst_n)
+	begin
+		cr0 = 16'h8f1f;
+		cr1 = 16'h0002;
+		lc  = LATENCY;
+	end
+
+	initial
+	begin
+		cr0 = 16'h8f1f;
+		cr1 = 16'h0002;
+		lc  = LATENCY;
+		dq_oe   = 1'b0;
+		rwds_oe = 1'b0;
+	end
+
+	always @(cr0)
+		case (cr0[7:4])
+			4'he:    lc = 3;
+			4'hf:    lc = 4;
+			4'h0:    lc = 5;
+			4'h1:    lc = 6;
+			4'h2:    lc = 7;
+			default: lc = LATENCY;
+		endcase
+
+
+	// Protocol
+	// --------
+
+	assign dq   = dq_oe   ? dq_out   : 8'hzz;
+	assign rwds = rwds_oe ? rwds_out : 1'bz;
+
+	assign ca_read = ca[47];
+	assign ca_reg  = ca[46];
+
+	// Start / End
+	always @(negedge cs_n)
+	begin
+		edge_cnt = 0;
+
+		// Always signal 2x latency during CA
+		rwds_out <= #(T_CO) 1'b1;
+		rwds_oe  <= #(T_CO) 1'b1;
+	end
+
+	always @(posedge cs_n)
+	begin
+		dq_oe   <= #(T_CO) 1'b0;
+		rwds_oe <= #(T_CO) 1'b0;
+	end
+
+	// Both clock edges
+	always @(ck)
+		if (~cs_n && ((ck === 1'b0) || (ck === 1'b1))) begin
+			if (edge_cnt < 6) begin
+				// Command / Address
+				ca = { ca[39:0], dq };
+
+				if (edge_cnt == 5) begin
+					// (use 'ca' directly, the wires aren't updated yet)
+					addr = { ca[44:16], ca[2:0] };
+					data_edge = (ca[46] & ~ca[47]) ? 6 : (2 * (LAT_OFS + 2 * lc));
+
+					// For reads, RWDS stays low until data, for writes
+					// it's released for the controller to drive the mask
+					rwds_out <= #(T_CO) 1'b0;
+					rwds_oe  <= #(T_CO) ca[47];
+				end
+
+			end else if (edge_cnt >= data_edge) begin
+				k = edge_cnt - data_edge;
+
+				if (ca_read) begin
+					// Read (memory or register)
+					rd_data = rd_word(addr, ca_reg);
+					dq_out   <= #(T_CO) (k % 2) ? rd_data[7:0] : rd_data[15:8];
+					dq_oe    <= #(T_CO) 1'b1;
+					rwds_out <= #(T_CO) ((k % 2) == 0);
+
+					if (k % 2)
+						addr = addr + 1;
+
+				end else if (ca_reg) begin
+					// Register write
+					if ((k % 2) == 0)
+						wr_byte = dq;
+					else if (k == 1) begin
+						if (addr == 32'h00000800)
+							cr0 = { wr_byte, dq };
+						else if (addr == 32'h00000801)
+							cr1 = { wr_byte, dq };
+					end
+
+				end else begin
+					// Memory write (RWDS high masks the byte)
+					if ((k % 2) == 0) begin
+						if (~rwds)
+							mem[addr[AW-1:0]][15:8] = dq;
+					end else begin
+						if (~rwds)
+							mem[addr[AW-1:0]][7:0] = dq;
+						addr = addr + 1;
+					end
+				end
+			end
+
+			edge_cnt = edge_cnt + 1;
+		end
+
+	// Read data source
+	function [15:0] rd_word;
+		input [31:0] a;
+		input        r;
+		begin
+			if (~r)
+				rd_word = mem[a[AW-1:0]];
+			else
+				case (a)
+					32'h00000000: rd_word = 16'h0c81;	// ID0
+					32'h00000001: rd_word = 16'h0001;	// ID1
+					32'h00000800: rd_word = cr0;
+					32'h00000801: rd_word = cr1;
+					default:      rd_word = 16'h0000;
+				endcase
+		end
+	endfunction
+
+endmodule // hyperram
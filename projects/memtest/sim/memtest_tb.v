@@ -0,0 +1,758 @@
+/*
+ * memtest_tb.v
+ *
+ * vim: ts=4 sw=4
+ *
+ * Copyright (C) 2020-2021  Sylvain Munaut <tnt@246tNt.com>
+ * SPDX-License-Identifier: CERN-OHL-P-2.0
+ */
+
+`default_nettype none
+`timescale 1ns / 100ps
+
+//
+// Memory tester / HDMI DMA benchmark
+//
+// Same datapath as top.v (memtest, hdmi_out and the memory controller
+// selected by MEM_spi (default) / MEM_hyperram) but with the wishbone bus
+// driven directly and a behavioural memory model on the pads. For each
+// scenario it reports bandwidth / latency from the memtest performance
+// counters, data integrity from the hardware checker, and the number of
+// underflowed lines when running the HDMI DMA.
+//
+// Use 'make MEM=hyperram' to select the HyperRAM path.
+//
+
+module memtest_tb;
+
+	// Params
+	// ------
+
+	// Clock (4x, the 1x is derived)
+	localparam real T_4X = 6.8;
+	localparam real T_1X = 4 * T_4X;
+
+	// Memory model latency
+	localparam integer PSRAM_DUMMY_CLK = 6;
+	localparam integer HRAM_LATENCY    = 3;
+
+	// HyperRAM controller PHY config (must match the model / T_RD)
+	localparam real    HRAM_T_RD     = 2.0;
+	localparam integer HRAM_EDGE     = 1;
+	localparam integer HRAM_PHASE    = 0;
+	localparam integer HRAM_DELAY    = 0;
+	localparam integer HRAM_CAP_LAT  = 3;
+
+	// Scenarios
+	localparam integer N_WORDS    = 1024;
+	localparam integer HDMI_LINES = 8;
+	localparam integer HDMI_FB    = 32'h00002000;
+
+`ifdef MEM_hyperram
+	localparam [31:0] RAM_BASE = 32'h00000000;	// CS0
+`else
+	localparam [31:0] RAM_BASE = 32'h40000000;	// CS1
+`endif
+
+	// Wishbone slaves
+	localparam integer WB_MC = 0;
+	localparam integer WB_MT = 1;
+	localparam integer WB_HD = 2;
+
+
+	// Signals
+	// -------
+
+	// Wishbone interface
+	reg  [31:0] wb_wdata;
+	wire [95:0] wb_rdata;
+	reg  [15:0] wb_addr;
+	reg         wb_we;
+	reg  [ 2:0] wb_cyc;
+	wire [ 2:0] wb_ack;
+
+	// Memory interface
+	wire [31:0] mi_addr;
+	wire [ 6:0] mi_len;
+	wire        mi_rw;
+	wire        mi_valid;
+	wire        mi_ready;
+
+	wire [31:0] mi_wdata;
+	wire        mi_wack;
+	wire        mi_wlast;
+
+	wire [31:0] mi_rdata;
+	wire        mi_rstb;
+	wire        mi_rlast;
+
+	// Memory interface - Memory Tester
+	wire [31:0] mi0_addr;
+	wire [ 6:0] mi0_len;
+	wire        mi0_rw;
+	wire        mi0_valid;
+	wire        mi0_ready;
+
+	wire [31:0] mi0_wdata;
+	wire        mi0_wack;
+
+	wire [31:0] mi0_rdata;
+	wire        mi0_rstb;
+
+	// Memory interface - Video DMA
+	wire [31:0] mi1_addr;
+	wire [ 6:0] mi1_len;
+	wire        mi1_rw;
+	wire        mi1_valid;
+	wire        mi1_ready;
+
+	wire [31:0] mi1_wdata;
+	wire        mi1_wack;
+	wire        mi1_wlast;
+
+	wire [31:0] mi1_rdata;
+	wire        mi1_rstb;
+	wire        mi1_rlast;
+
+	reg         dma_run;
+
+	// Pads
+`ifdef MEM_hyperram
+	wire [ 7:0] hram_dq;
+	wire        hram_rwds;
+	wire        hram_ck;
+	wire [ 3:0] hram_cs_n;
+	wire        hram_rst_n;
+`else
+	wire [ 3:0] spi_io;
+	wire        spi_sck;
+	wire [ 1:0] spi_cs_n;
+`endif
+
+	// Stats
+	integer     errors;
+	integer     hd_uf;
+	integer     hd_words;
+
+	// Clocks / Reset
+	reg  clk_4x = 1'b0;
+	reg  pll_lock = 1'b0;
+	wire clk_1x;
+	wire clk_2x;
+	wire clk_rd;
+	wire sync_4x;
+	wire sync_rd;
+	wire rst;
+
+
+	// Recording setup
+	// ---------------
+
+	initial begin
+`ifdef WITH_VCD
+		$dumpfile("memtest_tb.vcd");
+		$dumpvars(0,memtest_tb);
+`endif
+		# 50000000 $display("[!] Timeout");
+		$finish;
+	end
+
+
+	// Wishbone helpers
+	// ----------------
+
+	task wb_write;
+		input integer    slave;
+		input     [15:0] addr;
+		input     [31:0] data;
+		begin
+			@(posedge clk_1x) #1;
+			wb_addr  = addr;
+			wb_wdata = data;
+			wb_we    = 1'b1;
+			wb_cyc   = 1 << slave;
+			@(posedge clk_1x) #1;
+			while (~wb_ack[slave]) begin
+				@(posedge clk_1x) #1;
+			end
+			wb_cyc   = 3'b000;
+			wb_we    = 1'b0;
+		end
+	endtask
+
+	task wb_read;
+		input  integer    slave;
+		input      [15:0] addr;
+		output     [31:0] data;
+		begin
+			@(posedge clk_1x) #1;
+			wb_addr  = addr;
+			wb_we    = 1'b0;
+			wb_cyc   = 1 << slave;
+			@(posedge clk_1x) #1;
+			while (~wb_ack[slave]) begin
+				@(posedge clk_1x) #1;
+			end
+			data     = wb_rdata[32*slave+:32];
+			wb_cyc   = 3'b000;
+		end
+	endtask
+
+
+	// Memory controller init
+	// ----------------------
+
+`ifdef MEM_hyperram
+	task hram_wait_idle;
+		reg [31:0] v;
+		begin
+			v = 0;
+			while (~v[2])
+				wb_read(WB_MC, 0, v);
+		end
+	endtask
+
+	task mem_init;
+		reg [47:0] ca;
+		begin
+			// Reset HyperRAM and controller
+			wb_write(WB_MC, 0, 32'h00000002);
+			hram_wait_idle;
+			wb_write(WB_MC, 0, 32'h00000000);
+			hram_wait_idle;
+
+			// CR0 : Latency, fixed latency, hybrid burst, 128 bytes
+			ca = (48'h1 << 46) | (48'h1 << 45) | ((48'h800 >> 3) << 16);
+
+			wb_write(WB_MC, 3, 32'h00000030);
+			wb_write(WB_MC, 2, ca[47:16]);
+			wb_write(WB_MC, 2, { ca[15:0], 16'h8f0c | (
+				(HRAM_LATENCY == 3) ? 16'h00e0 :
+				(HRAM_LATENCY == 4) ? 16'h00f0 :
+				(HRAM_LATENCY == 5) ? 16'h0000 : 16'h0010
+			) });
+			wb_write(WB_MC, 2, 32'h00000000);
+			wb_write(WB_MC, 1, 32'h00000002);	// CS0, Register, Write
+			hram_wait_idle;
+
+			// PHY config and run
+			wb_write(WB_MC, 0,
+				(HRAM_EDGE  << 22) |
+				(HRAM_PHASE << 20) |
+				(HRAM_DELAY << 16) |
+				(((HRAM_CAP_LAT - 1) & 15) << 12) |
+				(((HRAM_LATENCY - 2) & 15) <<  8) |
+				32'h00000001
+			);
+		end
+	endtask
+`else
+	task mem_init;
+		begin
+			// Release external control, the PSRAM model is already in QPI
+			wb_write(WB_MC, 0, 32'h00000004);
+		end
+	endtask
+`endif
+
+
+	// Scenarios
+	// ---------
+
+	// Busy stays set until all the data has been transferred / checked
+	task mt_wait;
+		reg [31:0] v;
+		begin
+			v = 32'h00000004;
+			while (v[2])
+				wb_read(WB_MT, 0, v);
+		end
+	endtask
+
+	task mt_run;
+		input [31:0] addr;
+		input integer n_words;
+		input integer burst_len;
+		input         read;
+		begin
+			wb_write(WB_MT, 1, addr);
+			wb_write(WB_MT, 5, (n_words / burst_len) - 1);
+			wb_write(WB_MT, 0,
+				(1 << 23) |				// Run
+				(1 << 19) |				// PRBS
+				(read ? (3 << 16) : 0) |	// Read + checker reset
+				(burst_len - 1)
+			);
+			mt_wait;
+		end
+	endtask
+
+	task perf_report;
+		input [8*5:1] name;
+		input integer burst_len;
+		reg [31:0] busy, stall, words, bursts, lat_sum, lat_n;
+		begin
+			wb_read(WB_MT, 8'h8, busy);
+			wb_read(WB_MT, 8'h9, stall);
+			wb_read(WB_MT, 8'ha, words);
+			wb_read(WB_MT, 8'hb, bursts);
+			wb_read(WB_MT, 8'hc, lat_sum);
+			wb_read(WB_MT, 8'hd, lat_n);
+
+			$display("  %s burst %3d : %7.2f MB/s, latency %5.1f cycles, %3d%% stall",
+				name, burst_len,
+				(words * 4000.0) / (busy * T_1X),
+				lat_n ? (1.0 * lat_sum / lat_n) : 0.0,
+				busy ? ((100 * stall) / busy) : 0
+			);
+		end
+	endtask
+
+	task bench;
+		input integer burst_len;
+		reg [31:0] err_cnt;
+		reg [31:0] err_addr;
+		begin
+			wb_write(WB_MT, 2, 32'h600dbabe + burst_len);
+
+			// Fill
+			wb_write(WB_MT, 8, 0);
+			mt_run(RAM_BASE, N_WORDS, burst_len, 1'b0);
+			perf_report("write", burst_len);
+
+			// Check
+			wb_write(WB_MT, 8, 0);
+			mt_run(RAM_BASE, N_WORDS, burst_len, 1'b1);
+			perf_report("read ", burst_len);
+
+			wb_read(WB_MT, 3, err_cnt);
+			wb_read(WB_MT, 4, err_addr);
+
+			if (err_cnt != 0) begin
+				$display("  [!] %0d words failed, first @ %08x", err_cnt, err_addr);
+				errors = errors + err_cnt;
+			end
+		end
+	endtask
+
+	task hdmi_bench;
+		input integer burst_len;
+		integer    line_words;
+		integer    bn_cnt;
+		integer    bl_len;
+		integer    n;
+		real       t0;
+		begin
+			line_words = 240;	// 4bpp
+			bn_cnt = (line_words - 1) / burst_len;
+			bl_len = line_words - (burst_len * bn_cnt) - 1;
+
+			// Frame buffer content (fully written once mt_run returns, so
+			// the DMA can get the memory interface)
+			mt_run(RAM_BASE + HDMI_FB, (HDMI_LINES * line_words + 127) & ~127, 128, 1'b0);
+
+			// Config and start DMA (writing the base restarts the DMA at
+			// the start of the frame buffer, no need to wait for a frame)
+			wb_write(WB_HD, 2, 0);
+			wb_write(WB_HD, 1, RAM_BASE + HDMI_FB);
+			wb_write(WB_HD, 0, (1 << 31) | (bn_cnt << 24) | ((burst_len - 1) << 16) | (bl_len << 8) | bl_len);
+			dma_run = 1'b1;
+
+			// Run for a few lines. The DMA for a line is issued at the
+			// previous line start, so count from the first line start after
+			// enabling and check the following HDMI_LINES starts. Sampled
+			// on the falling edge to not race the RTL.
+			n = 0;
+			while (n <= HDMI_LINES) begin
+				@(negedge clk_1x);
+				if (hdmi_I.vt_trig) begin
+					if (n == 0) begin
+						hd_uf    = 0;
+						hd_words = 0;
+						t0 = $realtime;
+					end else if (hdmi_I.uf_line)
+						hd_uf = hd_uf + 1;
+					n = n + 1;
+				end
+			end
+
+			$display("  hdmi  burst %3d : %7.2f MB/s, %0d / %0d lines underflowed",
+				burst_len,
+				(hd_words * 4000.0) / ($realtime - t0),
+				hd_uf, HDMI_LINES
+			);
+
+			// Stop (and let the last line complete)
+			wb_write(WB_HD, 0, 0);
+			@(posedge hdmi_I.vt_trig);
+			dma_run = 1'b0;
+		end
+	endtask
+
+	always @(negedge clk_1x)
+		if (mi1_rstb)
+			hd_words = hd_words + 1;
+
+	initial
+	begin
+		// Init
+		wb_cyc   = 3'b000;
+		wb_we    = 1'b0;
+		wb_addr  = 16'h0000;
+		wb_wdata = 32'h00000000;
+		dma_run  = 1'b0;
+		errors   = 0;
+		hd_uf    = 0;
+		hd_words = 0;
+
+		// Wait for reset
+		#200 pll_lock = 1'b1;
+		@(negedge rst);
+		repeat (16) @(posedge clk_1x);
+
+		// Memory controller
+		mem_init;
+
+		// Memory tester
+		$display("[+] Memory tester (%0d words)", N_WORDS);
+		bench(  8);
+		bench( 32);
+		bench(128);
+
+		// HDMI DMA
+		$display("[+] HDMI DMA");
+		hdmi_bench( 16);
+		hdmi_bench( 64);
+		hdmi_bench(128);
+
+		// Result
+		if (errors == 0)
+			$display("[.] All good !");
+		else
+			$display("[!] %0d errors", errors);
+
+		$finish;
+	end
+
+
+	// Memory controller
+	// -----------------
+
+`ifdef MEM_hyperram
+	// Signals
+	wire [ 1:0] phy_ck_en;
+
+	wire [ 3:0] phy_rwds_in;
+	wire [ 3:0] phy_rwds_out;
+	wire [ 1:0] phy_rwds_oe;
+
+	wire [31:0] phy_dq_in;
+	wire [31:0] phy_dq_out;
+	wire [ 1:0] phy_dq_oe;
+
+	wire [ 3:0] phy_cs_n;
+	wire        phy_rst_n;
+
+	wire [ 7:0] phy_cfg_wdata;
+	wire [ 7:0] phy_cfg_rdata;
+	wire        phy_cfg_stb;
+
+	// Controller
+	hbus_memctrl hram_ctrl_I (
+		.phy_ck_en     (phy_ck_en),
+		.phy_rwds_in   (phy_rwds_in),
+		.phy_rwds_out  (phy_rwds_out),
+		.phy_rwds_oe   (phy_rwds_oe),
+		.phy_dq_in     (phy_dq_in),
+		.phy_dq_out    (phy_dq_out),
+		.phy_dq_oe     (phy_dq_oe),
+		.phy_cs_n      (phy_cs_n),
+		.phy_rst_n     (phy_rst_n),
+		.phy_cfg_wdata (phy_cfg_wdata),
+		.phy_cfg_rdata (phy_cfg_rdata),
+		.phy_cfg_stb   (phy_cfg_stb),
+		.mi_addr_cs    (mi_addr[31:30]),
+		.mi_addr       ({1'b0, mi_addr[29:0], 1'b0}),	/* 32b aligned */
+		.mi_len        (mi_len),
+		.mi_rw         (mi_rw),
+		.mi_linear     (1'b0),
+		.mi_valid      (mi_valid),
+		.mi_ready      (mi_ready),
+		.mi_wdata      (mi_wdata),
+		.mi_wmsk       (4'h0),
+		.mi_wack       (mi_wack),
+		.mi_rdata      (mi_rdata),
+		.mi_rstb       (mi_rstb),
+		.wb_wdata      (wb_wdata),
+		.wb_rdata      (wb_rdata[31:0]),
+		.wb_addr       (wb_addr[3:0]),
+		.wb_we         (wb_we),
+		.wb_cyc        (wb_cyc[0]),
+		.wb_ack        (wb_ack[0]),
+		.clk           (clk_1x),
+		.rst           (rst)
+	);
+
+	// PHY
+	hbus_phy_ice40 hram_phy_I (
+		.hbus_dq       (hram_dq),
+		.hbus_rwds     (hram_rwds),
+		.hbus_ck       (hram_ck),
+		.hbus_cs_n     (hram_cs_n),
+		.hbus_rst_n    (hram_rst_n),
+		.phy_ck_en     (phy_ck_en),
+		.phy_rwds_in   (phy_rwds_in),
+		.phy_rwds_out  (phy_rwds_out),
+		.phy_rwds_oe   (phy_rwds_oe),
+		.phy_dq_in     (phy_dq_in),
+		.phy_dq_out    (phy_dq_out),
+		.phy_dq_oe     (phy_dq_oe),
+		.phy_cs_n      (phy_cs_n),
+		.phy_rst_n     (phy_rst_n),
+		.phy_cfg_wdata (phy_cfg_wdata),
+		.phy_cfg_rdata (phy_cfg_rdata),
+		.phy_cfg_stb   (phy_cfg_stb),
+		.clk_rd_delay  (4'h0),
+		.clk_1x        (clk_1x),
+		.clk_4x        (clk_4x),
+		.clk_rd        (clk_rd),
+		.sync_4x       (sync_4x),
+		.sync_rd       (sync_rd)
+	);
+
+	// Memory
+	hyperram #(
+		.LATENCY (6),
+		.AW      (16)
+	) hram_I (
+		.dq    (hram_dq),
+		.rwds  (hram_rwds),
+		.ck    (hram_ck),
+		.cs_n  (hram_cs_n[0]),
+		.rst_n (hram_rst_n)
+	);
+
+	pulldown(hram_rwds);
+`else
+	// Config
+	localparam integer PHY_SPEED = 4;
+	localparam integer PL = (4 * PHY_SPEED) - 1;
+	localparam integer CL = PHY_SPEED - 1;
+
+	// Signals
+	wire [PL:0] phy_io_i;
+	wire [PL:0] phy_io_o;
+	wire [ 3:0] phy_io_oe;
+	wire [CL:0] phy_clk_o;
+	wire [ 1:0] phy_cs_o;
+
+	// Controller
+	qpi_memctrl #(
+		.CMD_READ   (16'hEBEB),
+		.CMD_WRITE  (16'h0202),
+		.DUMMY_CLK  (PSRAM_DUMMY_CLK),
+		.PAUSE_CLK  (8),
+		.FIFO_DEPTH (1),
+		.N_CS       (2),
+		.PHY_SPEED  (PHY_SPEED),
+		.PHY_WIDTH  (1),
+		.PHY_DELAY  (4)
+	) memctrl_I (
+		.phy_io_i   (phy_io_i),
+		.phy_io_o   (phy_io_o),
+		.phy_io_oe  (phy_io_oe),
+		.phy_clk_o  (phy_clk_o),
+		.phy_cs_o   (phy_cs_o),
+		.mi_addr_cs (mi_addr[31:30]),
+		.mi_addr    ({mi_addr[21:0], 2'b00 }),	/* 32 bits aligned */
+		.mi_len     (mi_len),
+		.mi_rw      (mi_rw),
+		.mi_valid   (mi_valid),
+		.mi_ready   (mi_ready),
+		.mi_wdata   (mi_wdata),
+		.mi_wack    (mi_wack),
+		.mi_wlast   (mi_wlast),
+		.mi_rdata   (mi_rdata),
+		.mi_rstb    (mi_rstb),
+		.mi_rlast   (mi_rlast),
+		.wb_wdata   (wb_wdata),
+		.wb_rdata   (wb_rdata[31:0]),
+		.wb_addr    (wb_addr[4:0]),
+		.wb_we      (wb_we),
+		.wb_cyc     (wb_cyc[0]),
+		.wb_ack     (wb_ack[0]),
+		.clk        (clk_1x),
+		.rst        (rst)
+	);
+
+	// PHY
+	qpi_phy_ice40_4x #(
+		.N_CS     (2),
+		.WITH_CLK (1)
+	) phy_I (
+		.pad_io    (spi_io),
+		.pad_clk   (spi_sck),
+		.pad_cs_n  (spi_cs_n),
+		.phy_io_i  (phy_io_i),
+		.phy_io_o  (phy_io_o),
+		.phy_io_oe (phy_io_oe),
+		.phy_clk_o (phy_clk_o),
+		.phy_cs_o  (phy_cs_o),
+		.clk_1x    (clk_1x),
+		.clk_4x    (clk_4x),
+		.clk_sync  (sync_4x)
+	);
+
+	// Memory
+	qspi_psram #(
+		.DUMMY_CLK (PSRAM_DUMMY_CLK),
+		.AW        (16)
+	) psram_I (
+		.io   (spi_io),
+		.sck  (spi_sck),
+		.cs_n (spi_cs_n[1])
+	);
+
+	pullup(spi_io[0]);
+	pullup(spi_io[1]);
+	pullup(spi_io[2]);
+	pullup(spi_io[3]);
+`endif
+
+
+	// Memory tester
+	// -------------
+
+	memtest #(
+		.ADDR_WIDTH(32)
+	) memtest_I (
+		.mi_addr  (mi0_addr),
+		.mi_len   (mi0_len),
+		.mi_rw    (mi0_rw),
+		.mi_valid (mi0_valid),
+		.mi_ready (mi0_ready),
+		.mi_wdata (mi0_wdata),
+		.mi_wack  (mi0_wack),
+		.mi_rdata (mi0_rdata),
+		.mi_rstb  (mi0_rstb),
+		.wb_wdata (wb_wdata),
+		.wb_rdata (wb_rdata[63:32]),
+		.wb_addr  (wb_addr[8:0]),
+		.wb_we    (wb_we),
+		.wb_cyc   (wb_cyc[1]),
+		.wb_ack   (wb_ack[1]),
+		.clk      (clk_1x),
+		.rst      (rst)
+	);
+
+
+	// Memory Mux
+	// ----------
+
+	assign mi_addr    = dma_run ? mi1_addr    : mi0_addr;
+	assign mi_len     = dma_run ? mi1_len     : mi0_len;
+	assign mi_rw      = dma_run ? mi1_rw      : mi0_rw;
+	assign mi_valid   = dma_run ? mi1_valid   : mi0_valid;
+	assign mi0_ready  = mi_ready & ~dma_run;
+	assign mi1_ready  = mi_ready &  dma_run;
+
+	assign mi_wdata  = dma_run ? mi1_wdata : mi0_wdata;
+	assign mi0_wack  = mi_wack & ~dma_run;
+	assign mi1_wack  = mi_wack &  dma_run;
+	assign mi1_wlast = mi_wlast;
+
+	assign mi0_rdata = mi_rdata;
+	assign mi0_rstb  = mi_rstb & ~dma_run;
+	assign mi1_rdata = mi_rdata;
+	assign mi1_rstb  = mi_rstb &  dma_run;
+	assign mi1_rlast = mi_rlast;
+
+`ifdef MEM_hyperram
+	// No rlast from the HyperRAM controller
+	assign mi_rlast = 1'b0;
+	assign mi_wlast = 1'b0;
+`endif
+
+
+	// HDMI output
+	// -----------
+
+	hdmi_out #(
+		.DW(4)
+	) hdmi_I (
+		.hdmi_data  (),
+		.hdmi_hsync (),
+		.hdmi_vsync (),
+		.hdmi_de    (),
+		.hdmi_clk   (),
+		.wb_wdata   (wb_wdata),
+		.wb_rdata   (wb_rdata[95:64]),
+		.wb_addr    (wb_addr[8:0]),
+		.wb_we      (wb_we),
+		.wb_cyc     (wb_cyc[2]),
+		.wb_ack     (wb_ack[2]),
+		.mi_addr    (mi1_addr),
+		.mi_len     (mi1_len),
+		.mi_rw      (mi1_rw),
+		.mi_valid   (mi1_valid),
+		.mi_ready   (mi1_ready),
+		.mi_wdata   (mi1_wdata),
+		.mi_wack    (mi1_wack),
+		.mi_wlast   (mi1_wlast),
+		.mi_rdata   (mi1_rdata),
+		.mi_rstb    (mi1_rstb),
+		.mi_rlast   (mi1_rlast),
+		.clk_1x     (clk_1x),
+		.clk_4x     (clk_4x),
+		.sync_4x    (sync_4x),
+		.rst        (rst)
+	);
+
+
+	// Clock / Reset
+	// -------------
+
+	always #(T_4X / 2) clk_4x <= ~clk_4x;
+
+	ice40_serdes_crg #(
+		.NO_CLOCK_2X(0)
+	) crg_I (
+		.clk_4x   (clk_4x),
+		.pll_lock (pll_lock),
+		.clk_1x   (clk_1x),
+		.clk_2x   (clk_2x),
+		.rst      (rst)
+	);
+
+	ice40_serdes_sync #(
+		.PHASE      (2),
+		.NEG_EDGE   (0),
+		.GLOBAL_BUF (0),
+		.LOCAL_BUF  (0)
+	) sync_4x_I (
+		.clk_slow (clk_1x),
+		.clk_fast (clk_4x),
+		.rst      (rst),
+		.sync     (sync_4x)
+	);
+
+`ifdef MEM_hyperram
+	assign #(HRAM_T_RD) clk_rd = clk_4x;
+
+	ice40_serdes_sync #(
+		.PHASE      (2),
+		.NEG_EDGE   (0),
+		.GLOBAL_BUF (0),
+		.LOCAL_BUF  (0)
+	) sync_rd_I (
+		.clk_slow (clk_1x),
+		.clk_fast (clk_rd),
+		.rst      (rst),
+		.sync     (sync_rd)
+	);
+`else
+	assign clk_rd  = 1'b0;
+	assign sync_rd = 1'b0;
+`endif
+
+endmodule // memtest_tb
@@ -0,0 +1,96 @@
+/*
+ * qspi_psram.v
+ *
+ * vim: ts=4 sw=4
+ *
+ * Copyright (C) 2020-2021  Sylvain Munaut <tnt@246tNt.com>
+ * SPDX-License-Identifier: CERN-OHL-P-2.0
+ */
+
+`default_nettype none
+`timescale 1ns / 100ps
+
+//
+// Behavioural model of a QPI PSRAM (ESP-PSRAM64H / APS6404L like)
+//
+// The chip is assumed to already be in QPI mode and only the commands
+// used by the memory controller are supported :
+//
+//  - 0xEB : Fast Read Quad, with DUMMY_CLK wait cycles
+//  - 0x02 / 0x38 : Write
+//
+// Inputs are sampled on the rising edge of the clock and outputs are
+// updated T_CO after the falling edge. Address wraps every 2^AW bytes.
+//
+
+module qspi_psram #(
+	parameter integer DUMMY_CLK = 6,
+	parameter integer AW = 16,
+	parameter integer T_CO = 2
+)(
+	inout  wire [3:0] io,
+	input  wire       sck,
+	input  wire       cs_n
+);
+
+	// Signals
+	// -------
+
+	reg  [7:0] mem[0:(1<<AW)-1];
+
+	reg  [7:0] cmd;
+	reg [23:0] addr;
+	reg  [3:0] wr_nibble;
+	integer    cnt;
+	integer    k;
+
+	reg  [3:0] io_out;
+	reg        io_oe;
+
+
+	// Protocol
+	// --------
+
+	initial
+		io_oe = 1'b0;
+
+	assign io = io_oe ? io_out : 4'bzzzz;
+
+	always @(negedge cs_n)
+		cnt = 0;
+
+	always @(posedge cs_n)
+		io_oe <= #(T_CO) 1'b0;
+
+	// Command / Address / Write data
+	always @(posedge sck)
+		if (~cs_n) begin
+			if (cnt < 2)
+				cmd = { cmd[3:0], io };
+			else if (cnt < 8)
+				addr = { addr[19:0], io };
+			else if ((cmd == 8'h02) || (cmd == 8'h38)) begin
+				if (((cnt - 8) % 2) == 0)
+					wr_nibble = io;
+				else begin
+					mem[addr[AW-1:0]] = { wr_nibble, io };
+					addr = addr + 1;
+				end
+			end
+
+			cnt = cnt + 1;
+		end
+
+	// Read data
+	always @(negedge sck)
+		if (~cs_n && (cmd == 8'heb) && (cnt >= (8 + DUMMY_CLK))) begin
+			k = cnt - 8 - DUMMY_CLK;
+
+			io_out <= #(T_CO) (k % 2) ? mem[addr[AW-1:0]][3:0] : mem[addr[AW-1:0]][7:4];
+			io_oe  <= #(T_CO) 1'b1;
+
+			if (k % 2)
+				addr = addr + 1;
+		end
+
+endmodule // qspi_psram
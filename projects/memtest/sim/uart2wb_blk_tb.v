@@ -0,0 +1,334 @@
+/*
+ * uart2wb_blk_tb.v
+ *
+ * vim: ts=4 sw=4
+ *
+ * Copyright (C) 2020-2021  Sylvain Munaut <tnt@246tNt.com>
+ * SPDX-License-Identifier: CERN-OHL-P-2.0
+ */
+
+`default_nettype none
+`timescale 1ns / 100ps
+
+//
+// UART level test of the serial to wishbone bridge : drives the
+// commands from memtest.py over the UART pins and checks the replies
+// and the accesses against simple memory slaves.
+//
+
+module uart2wb_blk_tb;
+
+	// Params
+	// ------
+
+	localparam integer UART_DIV = 8;
+	localparam integer WB_N = 3;
+
+	localparam [3:0]
+		OP_SYNC       = 4'h0,
+		OP_REG_ACCESS = 4'h1,
+		OP_DATA_SET   = 4'h2,
+		OP_DATA_GET   = 4'h3,
+		OP_AUX_CSR    = 4'h4,
+		OP_BLK_WRITE  = 4'h5,
+		OP_BLK_READ   = 4'h6;
+
+
+	// Signals
+	// -------
+
+	reg clk = 1'b0;
+	reg rst = 1'b1;
+
+	// UART
+	reg  uart_rx = 1'b1;
+	wire uart_tx;
+
+	// Wishbone
+	wire [31:0] wb_wdata;
+	wire [(32*WB_N)-1:0] wb_rdata;
+	wire [15:0] wb_addr;
+	wire        wb_we;
+	wire [WB_N-1:0] wb_cyc;
+	wire [WB_N-1:0] wb_ack;
+
+	wire [31:0] aux_csr;
+
+	// Test
+	reg   [7:0] rx_buf[0:255];
+	integer     rx_wr;
+	integer     rx_rd;
+	integer     errors;
+
+
+	// Setup recording
+	// ---------------
+
+	initial begin
+		$dumpfile("uart2wb_blk_tb.vcd");
+		$dumpvars(0,uart2wb_blk_tb);
+		# 20000000 $display("[!] Timeout");
+		$finish;
+	end
+
+	always #10 clk <= !clk;
+
+	initial begin
+		#200 rst = 0;
+	end
+
+
+	// DUT
+	// ---
+
+	uart2wb_blk #(
+		.UART_DIV(UART_DIV),
+		.WB_N(WB_N)
+	) dut_I (
+		.uart_rx  (uart_rx),
+		.uart_tx  (uart_tx),
+		.wb_wdata (wb_wdata),
+		.wb_rdata (wb_rdata),
+		.wb_addr  (wb_addr),
+		.wb_we    (wb_we),
+		.wb_cyc   (wb_cyc),
+		.wb_ack   (wb_ack),
+		.aux_csr  (aux_csr),
+		.clk      (clk),
+		.rst      (rst)
+	);
+
+
+	// Wishbone slaves
+	// ---------------
+
+	// 16 words of memory each, same ack timing as the real ones
+	genvar i;
+
+	generate
+		for (i=0; i<WB_N; i=i+1)
+		begin : slave
+			reg [31:0] mem[0:15];
+			reg        ack;
+
+			always @(posedge clk)
+				ack <= wb_cyc[i] & ~ack;
+
+			always @(posedge clk)
+				if (ack & wb_we)
+					mem[wb_addr[3:0]] <= wb_wdata;
+
+			assign wb_ack[i] = ack;
+			assign wb_rdata[32*i+:32] = ack ? mem[wb_addr[3:0]] : 32'h00000000;
+		end
+	endgenerate
+
+
+	// UART host
+	// ---------
+
+	// Receiver (always running so no reply byte can be missed)
+	initial
+		rx_wr = 0;
+
+	always @(negedge uart_tx)
+	begin : rx
+		integer b;
+		reg [7:0] v;
+
+		// Middle of the start bit, then of each data bit
+		repeat (UART_DIV / 2) @(posedge clk);
+		for (b=0; b<8; b=b+1) begin
+			repeat (UART_DIV) @(posedge clk);
+			v = { uart_tx, v[7:1] };
+		end
+
+		// Stop bit
+		repeat (UART_DIV) @(posedge clk);
+
+		rx_buf[rx_wr[7:0]] = v;
+		rx_wr = rx_wr + 1;
+	end
+
+	task uart_send;
+		input [7:0] v;
+		integer b;
+		begin
+			uart_rx = 1'b0;
+			repeat (UART_DIV) @(posedge clk);
+			for (b=0; b<8; b=b+1) begin
+				uart_rx = v[b];
+				repeat (UART_DIV) @(posedge clk);
+			end
+			uart_rx = 1'b1;
+			repeat (UART_DIV) @(posedge clk);
+		end
+	endtask
+
+	task uart_recv_word;
+		output [31:0] v;
+		integer n;
+		begin
+			for (n=0; n<4; n=n+1) begin
+				while (rx_rd == rx_wr)
+					@(posedge clk);
+				v = { v[23:0], rx_buf[rx_rd[7:0]] };
+				rx_rd = rx_rd + 1;
+			end
+		end
+	endtask
+
+	task cmd;
+		input [ 3:0] op;
+		input [35:0] p;
+		begin
+			uart_send({ op, p[35:32] });
+			uart_send(p[31:24]);
+			uart_send(p[23:16]);
+			uart_send(p[15: 8]);
+			uart_send(p[ 7: 0]);
+		end
+	endtask
+
+	task check;
+		input [8*16:1] name;
+		input [31:0] got;
+		input [31:0] exp;
+		begin
+			if (got !== exp) begin
+				$display("  [!] %s : got %08x, expected %08x", name, got, exp);
+				errors = errors + 1;
+			end
+		end
+	endtask
+
+
+	// Protocol
+	// --------
+
+	task sync;
+		reg [31:0] v;
+		begin
+			uart_send({ OP_SYNC, 4'h0 });
+			uart_recv_word(v);
+			check("sync", v, 32'hcafebabe);
+		end
+	endtask
+
+	task reg_write;
+		input [ 3:0] slave;
+		input [15:0] addr;
+		input [31:0] data;
+		begin
+			cmd(OP_DATA_SET, { 4'h0, data });
+			cmd(OP_REG_ACCESS, { 15'h0000, 1'b0, slave, addr });
+		end
+	endtask
+
+	task reg_read;
+		input  [ 3:0] slave;
+		input  [15:0] addr;
+		output [31:0] data;
+		begin
+			cmd(OP_REG_ACCESS, { 15'h0000, 1'b1, slave, addr });
+			cmd(OP_DATA_GET, 36'h0);
+			uart_recv_word(data);
+		end
+	endtask
+
+	task blk_write;
+		input [ 3:0] slave;
+		input [15:0] addr;
+		input integer n;
+		input [31:0] base;
+		integer k;
+		reg [31:0] d;
+		begin
+			cmd(OP_BLK_WRITE, { 4'h0, n[11:0] - 12'd1, slave, addr });
+			for (k=0; k<n; k=k+1) begin
+				d = base + k;
+				uart_send(d[31:24]);
+				uart_send(d[23:16]);
+				uart_send(d[15: 8]);
+				uart_send(d[ 7: 0]);
+			end
+		end
+	endtask
+
+	task blk_read_check;
+		input [ 3:0] slave;
+		input [15:0] addr;
+		input integer n;
+		input [31:0] base;
+		integer k;
+		reg [31:0] d;
+		begin
+			cmd(OP_BLK_READ, { 4'h0, n[11:0] - 12'd1, slave, addr });
+			for (k=0; k<n; k=k+1) begin
+				uart_recv_word(d);
+				check("blk_read", d, base + k);
+			end
+		end
+	endtask
+
+
+	// Scenario
+	// --------
+
+	initial
+	begin : test
+		reg [31:0] v;
+
+		rx_rd  = 0;
+		errors = 0;
+
+		@(negedge rst);
+		repeat (16) @(posedge clk);
+
+		// SYNC
+		$display("[+] SYNC");
+		sync;
+
+		// AUX_CSR
+		$display("[+] AUX_CSR");
+		cmd(OP_AUX_CSR, { 4'h0, 32'h12345678 });
+		sync;
+		check("aux_csr", aux_csr, 32'h12345678);
+
+		// REG_ACCESS + DATA_SET / DATA_GET, on every slave
+		$display("[+] REG_ACCESS / DATA_GET");
+		reg_write(0, 16'h0003, 32'h0000c0de);
+		reg_write(1, 16'h0003, 32'h0001c0de);
+		reg_write(2, 16'h0003, 32'h0002c0de);
+
+		reg_read(0, 16'h0003, v); check("reg_read 0", v, 32'h0000c0de);
+		reg_read(1, 16'h0003, v); check("reg_read 1", v, 32'h0001c0de);
+		reg_read(2, 16'h0003, v); check("reg_read 2", v, 32'h0002c0de);
+
+		// BLK_WRITE / BLK_READ
+		$display("[+] BLK_WRITE / BLK_READ");
+		blk_write(1, 16'h0004, 8, 32'hb10c0000);
+		blk_read_check(1, 16'h0004, 8, 32'hb10c0000);
+		blk_read_check(0, 16'h0003, 1, 32'h0000c0de);
+
+		check("untouched", slave[1].mem[3], 32'h0001c0de);
+		check("untouched", slave[1].mem[12], 32'hxxxxxxxx);
+
+		// Unmapped slave : acked, reads 0 and the link keeps working
+		$display("[+] Unmapped slave");
+		reg_write(5, 16'h0000, 32'hdeadbeef);
+		reg_read(5, 16'h0000, v); check("unmapped read", v, 32'h00000000);
+		blk_write(15, 16'h0000, 2, 32'hdeadbeef);
+		blk_read_check(2, 16'h0003, 1, 32'h0002c0de);
+		sync;
+
+		// Result
+		if (errors == 0)
+			$display("[.] All good !");
+		else
+			$display("[!] %0d errors", errors);
+
+		$finish;
+	end
+
+endmodule // uart2wb_blk_tb
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+
+#
+# memtest-bench.py
+#
+# Measures the bandwidth / latency of the memory controller using the
+# performance counters of the memory tester
+#
+# Copyright (C) 2020-2021  Sylvain Munaut <tnt@246tNt.com>
+# SPDX-License-Identifier: MIT
+#
+
+import sys
+
+from memtest import WishboneInterface, MemoryTester, HDMIOutput
+from memtest import HyperRAMController, QSPIController
+
+
+# ----------------------------------------------------------------------------
+# Main
+# ----------------------------------------------------------------------------
+
+BURST_LENS = [ 1, 2, 4, 8, 16, 32, 64, 128 ]
+
+def RAM_ADDR_CS(cs, addr):
+	return (cs << 30) | addr
+
+
+def bench(memtest, addr, burst_len, read, n_words=1<<16):
+	# Run a sequence of bursts with performance counters cleared
+	memtest.perf_clear()
+	memtest.cmd_run(addr, n_words // burst_len, read, 'prbs', burst_len=burst_len)
+	memtest.wait_run()
+	return memtest.perf_read()
+
+
+def report(cs, burst_len, read, pf, sys_freq):
+	# Bandwidth over the time the controller was busy
+	mbps = (4 * pf['words'] * sys_freq) / (pf['busy'] * 1e6) if pf['busy'] else 0
+
+	# Average first word latency
+	lat = (pf['lat_sum'] / pf['lat_n']) if pf['lat_n'] else 0
+
+	print("  %d  | %3d | %-5s | %7.2f | %7.2f | %6.1f%%" % (
+		cs, burst_len, 'read' if read else 'write',
+		mbps, lat,
+		100.0 * pf['stall'] / pf['busy'] if pf['busy'] else 0
+	))
+
+
+def main(argv0, port='/dev/ttyUSB1', mem='hyperram', sys_freq='36.75e6'):
+	sys_freq = float(sys_freq)
+
+	# Connect to board
+	wb = WishboneInterface(port)
+
+	# Devices on the bus
+	memtest = MemoryTester(wb, 0x10000)
+	hdmi    = HDMIOutput(wb, 0x20000)
+
+	# Make sure to disable DMA
+	hdmi.disable()
+	wb.aux_csr(0)
+
+	# Memory init
+	if mem == 'hyperram':
+		hyperram = HyperRAMController(wb, 0x00000)
+
+		if hyperram.init() is False:
+			print("[!] Init failed")
+			return -1
+
+		hyperram.set_runtime(True)
+
+		cs_list = [cs for cs in range(4) if hyperram.csm & (1 << cs)]
+
+	elif mem == 'spi':
+		psram = QSPIController(wb, 0x00000, cs=1)
+		psram.spi_xfer(b'\x35')
+
+		cs_list = [ 1 ]
+
+	else:
+		print("[!] Unknown memory type '%s'" % mem)
+		return -1
+
+	# Sweep
+	print("[+] Benchmark (sys_freq = %.2f MHz, latency in cycles)" % (sys_freq / 1e6))
+	print("  CS | Len | Dir   |    MB/s | Latency | Stall")
+	print(" ----+-----+-------+---------+---------+--------")
+
+	for cs in cs_list:
+		for burst_len in BURST_LENS:
+			for read in [False, True]:
+				pf = bench(memtest, RAM_ADDR_CS(cs, 0), burst_len, read)
+				report(cs, burst_len, read, pf, sys_freq)
+
+	# Cleanup
+	if mem == 'spi':
+		psram.qpi_xfer(b'\xf5')
+
+	# Done
+	return 0
+
+
+if __name__ == '__main__':
+	sys.exit(main(*sys.argv) or 0)
@@ -19,6 +19,13 @@ from memtest import HyperRAMController
 # Main
 # ----------------------------------------------------------------------------
 
+# Each chip select is mapped to its own 1 GB (word addressed) slice.
+# Note that all the chips share the DQ / RWDS / CK lines, so striping
+# bursts across chip selects can't increase the bandwidth by itself. It
+# would require hbus_memctrl to overlap one chip's command / latency
+# phase with another one's data transfer, which it doesn't support.
+# Scanout bandwidth is best improved with longer bursts instead (see
+# memtest-bench.py).
 def RAM_ADDR_CS(cs, addr):
 	return (cs << 30) | addr
 
@@ -37,7 +44,7 @@ def main(argv0, port='/dev/ttyUSB1', filename=None):
 	wb.aux_csr(0)
 
 	# Initialize HyperRAM core
-	if hyperram.init() is False:
+	if hyperram.init(train='full', cache='hyperram-train.json') is False:
 		print("[!] Init failed")
 		return -1
 
@@ -52,6 +59,7 @@ def main(argv0, port='/dev/ttyUSB1', filename=None):
 
 			print("[+] Testing CS=%d" % cs)
 			good = memtest.run(RAM_ADDR_CS(cs, 0), 1<<21)
+			good &= memtest.run_patterns(RAM_ADDR_CS(cs, 0), 1<<21)
 			if good:
 				print("[.]  All good !")
 			else:
@@ -73,7 +81,7 @@ def main(argv0, port='/dev/ttyUSB1', filename=None):
 		# Start DMA
 		print("[+] Starting DMA")
 		wb.aux_csr(1)
-		hdmi.enable(RAM_ADDR_CS(3, 0), 16)
+		hdmi.enable(RAM_ADDR_CS(3, 0))
 
 	# Done
 	return 0
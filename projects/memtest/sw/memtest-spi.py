@@ -28,7 +28,7 @@ def RAM_ADDR_CS(cs, addr):
 	return (cs << 30) | addr
 
 
-def main(argv0, port='/dev/ttyUSB1', filename=None):
+def main(argv0, port='/dev/ttyUSB1', filename=None, fmt='4bpp'):
 	# Connect to board
 	wb = WishboneInterface(port)
 
@@ -56,10 +56,10 @@ def main(argv0, port='/dev/ttyUSB1', filename=None):
 
 		# Write a random page
 		data = bytes([random.randint(0,255) for i in range(256)])
-		psram.qpi_xfer(b'\x02\x01\x00\x00', data)
+		psram.qpi_write(0x010000, data)
 
 		# Read it back
-		rdata = psram.qpi_xfer(b'\xeb\x01\x00\x00', dummy_len=3, rx_len=256)
+		rdata = psram.qpi_read(0x010000, 256)
 
 		# Results
 		if data != rdata:
@@ -75,6 +75,7 @@ def main(argv0, port='/dev/ttyUSB1', filename=None):
 		# Run memtest on PSRAM
 		print("[+] Testing PSRAM")
 		good = memtest.run(RAM_ADDR_CS(1, 0), 1<<21)
+		good &= memtest.run_patterns(RAM_ADDR_CS(1, 0), 1<<21)
 		if good:
 			print("[.]  All good !")
 		else:
@@ -87,33 +88,45 @@ def main(argv0, port='/dev/ttyUSB1', filename=None):
 		# Load data file
 		print("[+] Uploading image data")
 
+		# (one pixel per byte in the file)
 		img = open(filename, 'rb').read()
-		img = bytearray([(a << 4) | b for a, b in zip(img[0::2], img[1::2])])
+		line_words = None
+
+		if fmt == '4bpp':
+			img = bytearray([(a << 4) | b for a, b in zip(img[0::2], img[1::2])])
+		elif fmt == 'tile':
+			img, line_words = hdmi.tile_encode(img)
+			print(" %d words per line (%d%% of 4bpp)" % (line_words, 100 * line_words // 240))
+
 		memtest.load_data(RAM_ADDR_CS(1, 0), img)
 
 		print("[+] Uploading palette")
-		try:
-			# Palette data from file
-			def to_col(d):
-				return (
-					(((d[2] + 0x08) >> 4) << 8) |
-					(((d[1] + 0x08) >> 4) << 4) |
-					(((d[0] + 0x08) >> 4) << 0) |
-					0
-				)
-			with open(filename + '.pal', 'rb') as fh:
-				pal = [to_col(fh.read(3)) for i in range(16)]
-			for i in range(4*16):
-				hdmi.pal_write(i, pal[i&15])
-		except:
-			# 1:1 palette
-			for i in range(4*16):
-				hdmi.pal_write(i, i&15)
+		if fmt == '8bpp':
+			# RGB332, needs a VIDEO=12bpp bitstream
+			hdmi.pal_load_rgb332()
+		else:
+			try:
+				# Palette data from file
+				def to_col(d):
+					return (
+						(((d[2] + 0x08) >> 4) << 8) |
+						(((d[1] + 0x08) >> 4) << 4) |
+						(((d[0] + 0x08) >> 4) << 0) |
+						0
+					)
+				with open(filename + '.pal', 'rb') as fh:
+					pal = [to_col(fh.read(3)) for i in range(16)]
+				for i in range(4*16):
+					hdmi.pal_write(i, pal[i&15])
+			except:
+				# 1:1 palette
+				for i in range(4*16):
+					hdmi.pal_write(i, i&15)
 
 		# Start DMA
 		print("[+] Starting DMA")
 		wb.aux_csr(1)
-		hdmi.enable(RAM_ADDR_CS(1, 0), 64)
+		hdmi.enable(RAM_ADDR_CS(1, 0), None, fmt, line_words)
 
 	# Done
 	return 0
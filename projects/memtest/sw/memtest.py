@@ -10,15 +10,34 @@
 #
 
 import binascii
+import contextlib
+import json
 import random
 import serial
 import sys
+import time
 
 
 # ----------------------------------------------------------------------------
 # Serial commands
 # ----------------------------------------------------------------------------
 
+class WishboneRead(object):
+	"""Handle to a read issued through WishboneInterface.read_defer().
+	The value is only available once the interface has been flushed."""
+
+	__slots__ = ('_value',)
+
+	def __init__(self):
+		self._value = None
+
+	@property
+	def value(self):
+		if self._value is None:
+			raise RuntimeError('Read result accessed before flush')
+		return self._value
+
+
 class WishboneInterface(object):
 
 	COMMANDS = {
@@ -27,9 +46,19 @@ class WishboneInterface(object):
 		'DATA_SET' : 2,
 		'DATA_GET' : 3,
 		'AUX_CSR' : 4,
+		'BLK_WRITE' : 5,
+		'BLK_READ' : 6,
 	}
 
-	def __init__(self, port):
+	# Max number of words per block command
+	BLK_MAX_WORDS = 4096
+
+	# Limits before an automatic flush of a batch. Replies need to fit
+	# comfortably within the serial timeout.
+	BATCH_MAX_BYTES = 64 * 1024
+	BATCH_MAX_READS = 256
+
+	def __init__(self, port, block=None):
 		self.ser = ser = serial.Serial()
 		ser.port = port
 		ser.baudrate = 2000000
@@ -37,9 +66,18 @@ class WishboneInterface(object):
 		ser.timeout = 0.1
 		ser.open()
 
+		# Command queue
+		self._wq = []
+		self._wq_len = 0
+		self._rq = []
+		self._batch = 0
+
 		if not self.sync():
 			raise RuntimeError("Unable to sync")
 
+		# Block transfer support (None = auto-detect)
+		self.has_block = self._probe_block() if block is None else block
+
 	def sync(self):
 		for i in range(10):
 			self.ser.write(b'\x00')
@@ -48,23 +86,122 @@ class WishboneInterface(object):
 				return True
 		return False
 
+	def _queue(self, data, rd=None):
+		self._wq.append(data)
+		self._wq_len += len(data)
+
+		if rd is not None:
+			self._rq.append(rd)
+
+		if (self._wq_len >= self.BATCH_MAX_BYTES) or (len(self._rq) >= self.BATCH_MAX_READS):
+			self.flush()
+		elif not self._batch:
+			self.flush()
+
+	def flush(self):
+		# Send all queued commands at once
+		if not self._wq:
+			return
+
+		self.ser.write(b''.join(self._wq))
+		self._wq = []
+		self._wq_len = 0
+
+		# Collect all the DATA_GET replies, they come back in order
+		if not self._rq:
+			return
+
+		n = len(self._rq)
+		d = self.ser.read(4 * n)
+		if len(d) != (4 * n):
+			self._rq = []
+			raise RuntimeError('Comm error')
+
+		for i, rd in enumerate(self._rq):
+			rd._value = int.from_bytes(d[4*i:4*i+4], 'big')
+
+		self._rq = []
+
+	@contextlib.contextmanager
+	def batch(self):
+		"""Queues all commands issued within the block and sends them
+		in as few serial transfers as possible. Reads must use
+		read_defer() to not force a flush."""
+		self._batch += 1
+		try:
+			yield self
+		finally:
+			self._batch -= 1
+			if not self._batch:
+				self.flush()
+
 	def write(self, addr, data):
 		cmd_a = ((self.COMMANDS['DATA_SET']   << 36) | data).to_bytes(5, 'big')
 		cmd_b = ((self.COMMANDS['REG_ACCESS'] << 36) | addr).to_bytes(5, 'big')
-		self.ser.write(cmd_a + cmd_b)
+		self._queue(cmd_a + cmd_b)
 
-	def read(self, addr):
+	def read_defer(self, addr):
 		cmd_a = ((self.COMMANDS['REG_ACCESS'] << 36) | (1<<20) | addr).to_bytes(5, 'big')
 		cmd_b = ((self.COMMANDS['DATA_GET']   << 36)).to_bytes(5, 'big')
-		self.ser.write(cmd_a + cmd_b)
-		d = self.ser.read(4)
-		if len(d) != 4:
-			raise RuntimeError('Comm error')
-		return int.from_bytes(d, 'big')
+		rd = WishboneRead()
+		self._queue(cmd_a + cmd_b, rd)
+		return rd
+
+	def read(self, addr):
+		rd = self.read_defer(addr)
+		self.flush()
+		return rd.value
 
 	def aux_csr(self, value):
 		cmd = ((self.COMMANDS['AUX_CSR'] << 36) | value).to_bytes(5, 'big')
-		self.ser.write(cmd)
+		self._queue(cmd)
+
+	def _blk_cmd(self, op, addr, n):
+		return ((self.COMMANDS[op] << 36) | ((n - 1) << 20) | addr).to_bytes(5, 'big')
+
+	def _probe_block(self):
+		# Bridges without block support ignore the command and don't
+		# reply, read the memtest status register
+		self.ser.write(self._blk_cmd('BLK_READ', 0x10000, 1))
+		return len(self.ser.read(4)) == 4
+
+	def write_block(self, addr, words):
+		# Fallback to single writes
+		if not self.has_block:
+			with self.batch():
+				for i, w in enumerate(words):
+					self.write(addr + i, w)
+			return
+
+		# Block writes, in max size chunks
+		for i in range(0, len(words), self.BLK_MAX_WORDS):
+			chunk = words[i:i+self.BLK_MAX_WORDS]
+			self._queue(
+				self._blk_cmd('BLK_WRITE', addr + i, len(chunk)) +
+				b''.join([w.to_bytes(4, 'big') for w in chunk])
+			)
+
+	def read_block(self, addr, n):
+		# Fallback to (batched) single reads
+		if not self.has_block:
+			with self.batch():
+				rv = [self.read_defer(addr + i) for i in range(n)]
+			return [r.value for r in rv]
+
+		# Block reads, in max size chunks. The bridge doesn't accept any
+		# command while replying, so each one is sent on its own
+		self.flush()
+
+		rv = []
+		for i in range(0, n, self.BLK_MAX_WORDS):
+			l = min(n - i, self.BLK_MAX_WORDS)
+			self.ser.write(self._blk_cmd('BLK_READ', addr + i, l))
+			d = self.ser.read(4 * l)
+			if len(d) != (4 * l):
+				raise RuntimeError('Comm error')
+			rv.extend([int.from_bytes(d[j:j+4], 'big') for j in range(0, 4*l, 4)])
+
+		return rv
 
 
 # ----------------------------------------------------------------------------
@@ -90,6 +227,9 @@ class QSPIController(object):
 	def _read(self, reg):
 		return self.intf.read(self.base + self.CORE_REGS.get(reg, reg))
 
+	def _read_defer(self, reg):
+		return self.intf.read_defer(self.base + self.CORE_REGS.get(reg, reg))
+
 	def _begin(self):
 		# Request external control
 		self._write('csr', 0x00000004 | (self.cs << 4))
@@ -100,49 +240,47 @@ class QSPIController(object):
 		self._write('csr', 0x00000004)
 
 	def spi_xfer(self, tx_data, dummy_len=0, rx_len=0):
-		# Start transaction
-		self._begin()
-
-		# Total length
-		l = len(tx_data) + rx_len + dummy_len
+		with self.intf.batch():
+			# Start transaction
+			self._begin()
 
-		# Prep buffers
-		tx_data = tx_data + bytes( ((l + 3) & ~3) - len(tx_data) )
-		rx_data = b''
+			# Total length
+			l = len(tx_data) + rx_len + dummy_len
 
-		# Run
-		while l > 0:
-			# Word and command
-			w = int.from_bytes(tx_data[0:4], 'big')
-			c = 0x13 if l >= 4 else (0x10 + l - 1)
-			s = 0 if l >= 4 else 8*(4-l)
+			# Prep buffers
+			tx_data = tx_data + bytes( ((l + 3) & ~3) - len(tx_data) )
+			rx_words = []
 
-			# Issue
-			self._write(c, w);
-			w = self._read('rf')
+			# Run
+			for o in range(0, l, 4):
+				# Word and command
+				w = int.from_bytes(tx_data[o:o+4], 'big')
+				c = 0x13 if (l - o) >= 4 else (0x10 + l - o - 1)
+				s = 0 if (l - o) >= 4 else 8*(4-l+o)
 
-			# Get RX
-			rx_data = rx_data + ((w << s) & 0xffffffff).to_bytes(4, 'big')
+				# Issue
+				self._write(c, w);
+				rx_words.append( (self._read_defer('rf'), s) )
 
-			# Next
-			l = l - 4
-			tx_data = tx_data[4:]
+			# End transaction
+			self._end()
 
-		# End transaction
-		self._end()
+		# Get RX
+		rx_data = b''.join([((w.value << s) & 0xffffffff).to_bytes(4, 'big') for w, s in rx_words])
 
 		# Return interesting part
 		return rx_data[-rx_len:]
 
 
 	def _qpi_tx(self, data, command=False):
-		while len(data):
+		data = memoryview(data)
+
+		for o in range(0, len(data), 4):
 			# Base command
 			cmd = 0x1c if command else 0x18
 
 			# Grab chunk
-			word = data[0:4]
-			data = data[4:]
+			word = bytes(data[o:o+4])
 
 			cmd |= len(word) - 1
 			word = word + bytes(-len(word) & 3)
@@ -151,50 +289,84 @@ class QSPIController(object):
 			self._write(cmd, int.from_bytes(word, 'big'));
 
 	def _qpi_rx(self, l):
-		data = b''
+		# Issue all reads
+		words = []
 
 		while l > 0:
-			# Issue read
 			wl = 4 if l >= 4 else l
 			cmd = 0x14 | (wl-1)
 			self._write(cmd, 0)
-			word = self._read('rf')
-
-			# Accumulate
-			data = data + (word & (0xffffffff >> (8*(4-wl)))).to_bytes(wl, 'big')
-
-			# Next
+			words.append( (self._read_defer('rf'), wl) )
 			l = l - 4
 
-		return data
+		# Result is only available once the caller flushed the batch
+		return words
+
+	def _qpi_rx_data(self, words):
+		return b''.join([(w.value & (0xffffffff >> (8*(4-wl)))).to_bytes(wl, 'big') for w, wl in words])
 
 	def qpi_xfer(self, cmd=b'', payload=b'', dummy_len=0, rx_len=0):
-		# Start transaction
-		self._begin()
+		with self.intf.batch():
+			rv = self._qpi_xfer_defer(cmd, payload, dummy_len, rx_len)
 
-		# TX command
-		if cmd:
-			self._qpi_tx(cmd, True)
+		return self._qpi_rx_data(rv) if rv is not None else None
 
-		# TX payload
-		if payload:
-			self._qpi_tx(payload, False)
+	def _qpi_xfer_defer(self, cmd=b'', payload=b'', dummy_len=0, rx_len=0):
+		# Queue a complete transaction, RX data is only available once
+		# the batch is flushed (see _qpi_rx_data)
+		with self.intf.batch():
+			# Start transaction
+			self._begin()
 
-		# Dummy
-		if dummy_len:
-			self._qpi_rx(dummy_len)
+			# TX command
+			if cmd:
+				self._qpi_tx(cmd, True)
 
-		# RX payload
-		if rx_len:
-			rv = self._qpi_rx(rx_len)
-		else:
-			rv = None
+			# TX payload
+			if payload:
+				self._qpi_tx(payload, False)
 
-		# End transaction
-		self._end()
+			# Dummy
+			if dummy_len:
+				self._qpi_rx(dummy_len)
+
+			# RX payload
+			if rx_len:
+				rv = self._qpi_rx(rx_len)
+			else:
+				rv = None
+
+			# End transaction
+			self._end()
 
 		return rv
 
+	def qpi_write(self, addr, data, page=1024):
+		# Standard QPI write (0x02), split on page boundaries, all sent
+		# at once
+		data = memoryview(data)
+		o = 0
+
+		with self.intf.batch():
+			while o < len(data):
+				l = min(page - ((addr + o) % page), len(data) - o)
+				self._qpi_xfer_defer(b'\x02' + (addr + o).to_bytes(3, 'big'), data[o:o+l])
+				o += l
+
+	def qpi_read(self, addr, length, page=1024):
+		# Fast Quad read (0xeb, 6 dummy clocks), split on page boundaries
+		# and with all the replies collected at once
+		rv = []
+		o = 0
+
+		with self.intf.batch():
+			while o < length:
+				l = min(page - ((addr + o) % page), length - o)
+				rv.append(self._qpi_xfer_defer(b'\xeb' + (addr + o).to_bytes(3, 'big'), dummy_len=3, rx_len=l))
+				o += l
+
+		return b''.join([self._qpi_rx_data(x) for x in rv])
+
 
 # ----------------------------------------------------------------------------
 # HyperRAM controller
@@ -233,6 +405,9 @@ class HyperRAMController(object):
 		#  - ANDing all bytes in a single word == 0
 	CAL_WORDS = [ 0x600dbabe, 0xb16b00b5 ]
 
+		# Capture latencies tried during full training
+	TRAIN_CAP_LATENCIES = range(3, 7)
+
 		# Register addresses
 	HYPERRAM_REGS = {
 		'id0': 0,
@@ -260,6 +435,9 @@ class HyperRAMController(object):
 	def _read(self, reg):
 		return self.intf.read(self.base + self.CORE_REGS[reg])
 
+	def _read_defer(self, reg):
+		return self.intf.read_defer(self.base + self.CORE_REGS[reg])
+
 	def _cr0(self, dpd=False, drive_strength=None, latency=6, fixed_latency=True, hybrid_burst=True, burst_len=32):
 		DRIVE = {
 			None: 0,
@@ -320,105 +498,317 @@ class HyperRAMController(object):
 		else:
 			raise RuntimeError('HyperRAM controller timeout')
 
+	def _idle_defer(self):
+		# Queue a status read to be checked with _idle_check() once
+		# the batch is flushed. Any command is done long before the next
+		# serial command is even received, so a single read is enough.
+		return self._read_defer('csr')
+
+	def _idle_check(self, st):
+		if not (st.value & self.CSR_IDLE_CFG):
+			raise RuntimeError('HyperRAM controller timeout')
+
+	def _wq_read_defer(self):
+		# Queue read of the 3 words of the read queue
+		# (wq1 must be read before wq0 for each word)
+		rv = []
+		for i in range(3):
+			w1 = self._read_defer('wq1')
+			w0 = self._read_defer('wq0')
+			rv.append( (w0, w1) )
+		return rv
+
 	def _reg_write(self, cs, reg, val):
 		ca = self._ca(self.HYPERRAM_REGS[reg], rwn=0, reg=1)
 
-		self._write('wq1', 0x30)
-		self._write('wq0', ca >> 16)
-		self._write('wq0', ((ca & 0xffff) << 16) | val)
-		self._write('wq0', 0)
+		with self.intf.batch():
+			self._write('wq1', 0x30)
+			self._write('wq0', ca >> 16)
+			self._write('wq0', ((ca & 0xffff) << 16) | val)
+			self._write('wq0', 0)
 
-		self._write('cmd',
-			self.CMD_CS(cs) |
-			self.CMD_REG |
-			self.CMD_WRITE
-		)
+			self._write('cmd',
+				self.CMD_CS(cs) |
+				self.CMD_REG |
+				self.CMD_WRITE
+			)
 
-		self._wait_idle()
+			st = self._idle_defer()
+
+		self._idle_check(st)
 
 	def _reg_read(self, cs, reg):
 		ca = self._ca(self.HYPERRAM_REGS[reg], rwn=1, reg=1)
 
-		self._write('wq1', 0x30)
-		self._write('wq0', ca >> 16)
+		with self.intf.batch():
+			self._write('wq1', 0x30)
+			self._write('wq0', ca >> 16)
 
-		self._write('wq1', 0x20)
-		self._write('wq0', (ca & 0xffff) << 16)
+			self._write('wq1', 0x20)
+			self._write('wq0', (ca & 0xffff) << 16)
 
-		self._write('wq1', 0x00)
-		self._write('wq0', 0)
+			self._write('wq1', 0x00)
+			self._write('wq0', 0)
 
-		self._write('cmd',
-			self.CMD_LAT(self._cmd_latency) |
-			self.CMD_CS(cs) |
-			self.CMD_REG |
-			self.CMD_READ
-		)
+			self._write('cmd',
+				self.CMD_LAT(self._cmd_latency) |
+				self.CMD_CS(cs) |
+				self.CMD_REG |
+				self.CMD_READ
+			)
 
-		self._wait_idle()
+			st = self._idle_defer()
+			rv = self._wq_read_defer()
 
-		rv = []
-		for i in range(3):
-			w1 = self._read('wq1')
-			w0 = self._read('wq0')
-			rv.append( (w0, w1) )
+		self._idle_check(st)
 
-		return rv[-1][0] >> 16
+		return rv[-1][0].value >> 16
 
 	def _mem_write(self, cs, addr, val, count=1, mask=0x0):
 		ca = self._ca(addr, rwn=0, reg=0)
 
-		self._write('wq1', 0x30)
-		self._write('wq0', ca >> 16)
+		with self.intf.batch():
+			self._write('wq1', 0x30)
+			self._write('wq0', ca >> 16)
 
-		self._write('wq1', 0x20)
-		self._write('wq0', (ca & 0xffff) << 16)
+			self._write('wq1', 0x20)
+			self._write('wq0', (ca & 0xffff) << 16)
 
-		self._write('wq1', 0x30 | mask)
-		self._write('wq0', val)
+			self._write('wq1', 0x30 | mask)
+			self._write('wq0', val)
 
-		self._write('cmd',
-			self.CMD_LEN(count) |
-			self.CMD_LAT(self._cmd_latency) |
-			self.CMD_CS(cs) |
-			self.CMD_MEM |
-			self.CMD_WRITE
-		)
+			self._write('cmd',
+				self.CMD_LEN(count) |
+				self.CMD_LAT(self._cmd_latency) |
+				self.CMD_CS(cs) |
+				self.CMD_MEM |
+				self.CMD_WRITE
+			)
 
-		self._wait_idle()
+			st = self._idle_defer()
 
-	def _mem_read(self, cs, addr, count=3):
+		self._idle_check(st)
+
+	def _mem_read_defer(self, cs, addr, count=3):
+		# Queue the read, returns the status and data handles
 		if count > 3:
 			raise ValueError('Unable to read more than 3 words at a time')
 
 		ca = self._ca(addr, rwn=1, reg=0)
 
-		self._write('wq1', 0x30)
-		self._write('wq0', ca >> 16)
+		with self.intf.batch():
+			self._write('wq1', 0x30)
+			self._write('wq0', ca >> 16)
 
-		self._write('wq1', 0x20)
-		self._write('wq0', (ca & 0xffff) << 16)
+			self._write('wq1', 0x20)
+			self._write('wq0', (ca & 0xffff) << 16)
 
-		self._write('wq1', 0x00)
-		self._write('wq0', 0)
+			self._write('wq1', 0x00)
+			self._write('wq0', 0)
 
-		self._write('cmd',
-			self.CMD_LEN(count) |
-			self.CMD_LAT(self._cmd_latency) |
-			self.CMD_CS(cs) |
-			self.CMD_MEM |
-			self.CMD_READ
+			self._write('cmd',
+				self.CMD_LEN(count) |
+				self.CMD_LAT(self._cmd_latency) |
+				self.CMD_CS(cs) |
+				self.CMD_MEM |
+				self.CMD_READ
+			)
+
+			st = self._idle_defer()
+			rv = self._wq_read_defer()
+
+		return st, rv[-count:]
+
+	def _mem_read(self, cs, addr, count=3):
+		with self.intf.batch():
+			st, rv = self._mem_read_defer(cs, addr, count)
+
+		self._idle_check(st)
+
+		return [ (w0.value, w1.value) for w0, w1 in rv ]
+
+	def _chip_setup(self, cs):
+		# CR write
+		self._reg_write(cs, 'cr0', self.cr0)
+		self._reg_write(cs, 'cr1', self.cr1)
+
+		# Write the calibration words
+		self._mem_write(cs, 0, self.CAL_WORDS[0], count=3)
+		self._mem_write(cs, 2, self.CAL_WORDS[1], count=1)
+
+	def _train_ref(self):
+		return [
+			(self.CAL_WORDS[0], 0x3a),
+			(self.CAL_WORDS[1], 0x3a),
+			(self.CAL_WORDS[0], 0x3a),
+		]
+
+	def _csr_phy(self, edge, phase, delay, cap_latency):
+		return (
+			self.CSR_PHY_EDGE(edge) |
+			self.CSR_PHY_PHASE(phase) |
+			self.CSR_PHY_DELAY(delay) |
+			self.CSR_CMD_LAT(self._cmd_latency) |
+			self.CSR_CAP_LAT(cap_latency)
 		)
 
-		self._wait_idle()
+	def _train_check_defer(self, cs, edge, phase, delay, cap_latency):
+		# Queue a calibration words read with the given PHY config
+		with self.intf.batch():
+			self._write('csr', self._csr_phy(edge, phase, delay, cap_latency))
+			return self._mem_read_defer(cs, 0, count=3)
 
-		rv = []
-		for i in range(3):
-			w1 = self._read('wq1')
-			w0 = self._read('wq0')
-			rv.append( (w0, w1) )
+	def _train_check_result(self, h):
+		st, rv = h
+		if not (st.value & self.CSR_IDLE_CFG):
+			return False
+		return [ (w0.value, w1.value) for w0, w1 in rv ] == self._train_ref()
+
+	def _train_eye_map(self, cs):
+		# Pass / Fail for every combination, all delays of a given
+		# (edge, cap_latency, phase) are checked in a single batch
+		eye = {}
+
+		for edge in range(2):
+			for cap_latency in self.TRAIN_CAP_LATENCIES:
+				for phase in range(4):
+					with self.intf.batch():
+						h = [ self._train_check_defer(cs, edge, phase, delay, cap_latency) for delay in range(16) ]
+					eye[(edge, cap_latency, phase)] = [ self._train_check_result(x) for x in h ]
+
+		return eye
+
+	def _train_print_eye(self, eye):
+		print("[.]  edge cap phase | delay 0 -> 15")
+		for (edge, cap_latency, phase), row in sorted(eye.items()):
+			if any(row):
+				print("[.]   %d    %d    %d    | %s" % (edge, cap_latency, phase, ''.join(['#' if x else '.' for x in row])))
+
+	def _train_widest(self, row):
+		# Widest run of passing delays, as (start, length)
+		best = (0, 0)
+		start = None
+
+		for i, x in enumerate(row + [ False ]):
+			if x and (start is None):
+				start = i
+			elif not x and (start is not None):
+				if (i - start) > best[1]:
+					best = (start, i - start)
+				start = None
+
+		return best
+
+	def _train_full(self):
+		# Eye map of each chip
+		eyes = {}
+
+		for cs in range(4):
+			if not self.csm & (1 << cs):
+				continue
+
+			print("[+] Training CS=%d (full sweep)" % cs)
+
+			self._chip_setup(cs)
+
+			eye = self._train_eye_map(cs)
+
+			if not any([any(row) for row in eye.values()]):
+				print("[w]  No working setting found, assuming chip is missing: disabling it !")
+				self.csm &= ~(1 << cs)
+				continue
+
+			self._train_print_eye(eye)
+			eyes[cs] = eye
+
+		# Are any chips still enabled ?
+		if not self.csm:
+			print("[!] All chips disabled, somethins is wrong ...")
+			return False
+
+		# Settings that work for all chips
+		print("[+] Compiling training results")
+
+		comb = {}
+		for k in next(iter(eyes.values())).keys():
+			comb[k] = [ all([eyes[cs][k][d] for cs in eyes]) for d in range(16) ]
+
+		self._train_print_eye(comb)
+
+		# Pick the widest eye and use its center
+		best = None
+
+		for k, row in comb.items():
+			start, length = self._train_widest(row)
+			if length and ((best is None) or (length > best[2])):
+				best = (k, start, length)
+
+		if best is None:
+			print("[!] Unable to find single valid combination for all chips :(")
+			return False
+
+		(self._edge, self._cap_latency, self._phase), start, length = best
+		self._delay = start + (length - 1) // 2
+
+		if length < 3:
+			print("[w] Training results might be marginal (eye only %d delay taps wide)" % length)
+
+		return True
+
+	def _train_load(self, filename):
+		# Load previous training results, if they apply
+		# (anything malformed is just a cache miss)
+		try:
+			with open(filename, 'r') as fh:
+				p = json.load(fh)
+			latency, burst_len, csm_req, csm, edge, phase, delay, cap_latency = [ int(p[k]) for k in
+				('latency', 'burst_len', 'csm_req', 'csm', 'edge', 'phase', 'delay', 'cap_latency') ]
+		except (OSError, ValueError, KeyError, TypeError):
+			return False
+
+		if (latency != self.latency) or (burst_len != self.burst_len):
+			return False
+
+		# Must be for the exact same set of requested chips (training
+		# then disables the ones that don't respond)
+		if (csm_req != self.csm) or (csm & ~csm_req):
+			return False
+
+		# Check they still work
+		for cs in range(4):
+			if csm & (1 << cs):
+				self._chip_setup(cs)
 
-		return rv[-count:]
+		with self.intf.batch():
+			h = [ self._train_check_defer(cs, edge, phase, delay, cap_latency)
+				for cs in range(4) if csm & (1 << cs) ]
+
+		if not all([self._train_check_result(x) for x in h]):
+			print("[w] Saved training results don't work anymore, re-training")
+			return False
+
+		self.csm          = csm
+		self._edge        = edge
+		self._phase       = phase
+		self._delay       = delay
+		self._cap_latency = cap_latency
+
+		print("[+] Using saved training results from '%s'" % filename)
+
+		return True
+
+	def _train_save(self, filename, csm_req):
+		with open(filename, 'w') as fh:
+			json.dump({
+				'latency':     self.latency,
+				'burst_len':   self.burst_len,
+				'csm_req':     csm_req,
+				'csm':         self.csm,
+				'edge':        self._edge,
+				'phase':       self._phase,
+				'delay':       self._delay,
+				'cap_latency': self._cap_latency,
+			}, fh, indent=4)
 
 	def _train_check_edge_delay(self, cs, edge, delay):
 		# Configure for base capture latency and phase
@@ -461,13 +851,7 @@ class HyperRAMController(object):
 		# Confirm data
 		data = self._mem_read(cs, 0, count=3)
 
-		ref = [
-			(self.CAL_WORDS[0], 0x3a),
-			(self.CAL_WORDS[1], 0x3a),
-			(self.CAL_WORDS[0], 0x3a),
-		]
-
-		if data != ref:
+		if data != self._train_ref():
 			return None
 
 		return (cap_latency, phase)
@@ -543,41 +927,7 @@ class HyperRAMController(object):
 		# Return delay and params
 		return d, best[0][0], best[0][1]
 
-	def init(self):
-		# Reset HyperRAM and controller
-		self._write('csr', self.CSR_RESET)
-		self._wait_idle()
-		self._write('csr', 0)
-		self._wait_idle()
-
-		# Chip config
-		self.cr0 = self._cr0(latency=self.latency, burst_len=self.burst_len)
-		self.cr1 = self._cr1()
-
-		# DEBUG
-		if False:
-			cs = 0
-
-			for i in range(5):
-				print(hex(self.cr0))
-				self._reg_write(cs, 'cr0', self.cr0)
-				self._mem_write(cs, 0, self.CAL_WORDS[0], count=3)
-				self._mem_write(cs, 2, self.CAL_WORDS[1], count=1)
-
-				self._write('csr',
-					self.CSR_PHY_EDGE(1) |
-					self.CSR_PHY_PHASE(0) |
-					self.CSR_PHY_DELAY(0) |
-					self.CSR_CMD_LAT(self._cmd_latency) |
-					self.CSR_CAP_LAT(3)
-				)
-				print(f"{self._read('csr'):08x}")
-
-				for w,a in self._mem_read(cs, 0, count=3):
-					print(f"{bin(a)} {w:08x}")
-
-			return False
-
+	def _train_quick(self):
 		# Execute configuration and training on all chips
 		edge = 1
 		train = {}
@@ -589,13 +939,8 @@ class HyperRAMController(object):
 			# Debug
 			print("[+] Training CS=%d" % cs)
 
-			# CR write
-			self._reg_write(cs, 'cr0', self.cr0)
-			self._reg_write(cs, 'cr1', self.cr1)
-
-			# Write the calibration words
-			self._mem_write(cs, 0, self.CAL_WORDS[0], count=3)
-			self._mem_write(cs, 2, self.CAL_WORDS[1], count=1)
+			# CR write / Calibration words
+			self._chip_setup(cs)
 
 			# Scan delays
 			any_valid = False
@@ -633,15 +978,73 @@ class HyperRAMController(object):
 		best = sorted(groups, key=lambda x: len(x[1]) + 2 * (x[2] + x[3]), reverse=True)[0]
 
 			# Select delay
+		self._edge = edge
 		self._delay, self._cap_latency, self._phase = self._train_pick_params(best)
 
+		return True
+
+	def init(self, train='quick', cache=None):
+		"""Resets and trains the PHY. 'train' is either 'quick' (a few
+		delays only) or 'full' (eye map of every delay / edge / phase /
+		capture latency). If 'cache' is given, results are saved to /
+		restored from that file, and only re-done if they fail."""
+
+		# Reset HyperRAM and controller
+		self._write('csr', self.CSR_RESET)
+		self._wait_idle()
+		self._write('csr', 0)
+		self._wait_idle()
+
+		# Chip config
+		self.cr0 = self._cr0(latency=self.latency, burst_len=self.burst_len)
+		self.cr1 = self._cr1()
+
+		# DEBUG
+		if False:
+			cs = 0
+
+			for i in range(5):
+				print(hex(self.cr0))
+				self._reg_write(cs, 'cr0', self.cr0)
+				self._mem_write(cs, 0, self.CAL_WORDS[0], count=3)
+				self._mem_write(cs, 2, self.CAL_WORDS[1], count=1)
+
+				self._write('csr',
+					self.CSR_PHY_EDGE(1) |
+					self.CSR_PHY_PHASE(0) |
+					self.CSR_PHY_DELAY(0) |
+					self.CSR_CMD_LAT(self._cmd_latency) |
+					self.CSR_CAP_LAT(3)
+				)
+				print(f"{self._read('csr'):08x}")
+
+				for w,a in self._mem_read(cs, 0, count=3):
+					print(f"{bin(a)} {w:08x}")
+
+			return False
+
+		# Training (or re-use of previous results)
+		csm_req = self.csm
+
+		if (cache is None) or not self._train_load(cache):
+			if train == 'full':
+				ok = self._train_full()
+			else:
+				ok = self._train_quick()
+
+			if not ok:
+				return False
+
+			if cache is not None:
+				self._train_save(cache, csm_req)
+
 		# Load final configuration
-		print("[+] Core configured for cmd_latency=%d, capture_latency=%d, phase=%d, delay=%d" % (
-			self._cmd_latency, self._cap_latency, self._phase, self._delay
+		print("[+] Core configured for cmd_latency=%d, capture_latency=%d, edge=%d, phase=%d, delay=%d" % (
+			self._cmd_latency, self._cap_latency, self._edge, self._phase, self._delay
 		))
 
 		self._csr = (
-			self.CSR_PHY_EDGE(edge) |
+			self.CSR_PHY_EDGE(self._edge) |
 			self.CSR_PHY_PHASE(self._phase) |
 			self.CSR_PHY_DELAY(self._delay) |
 			self.CSR_CMD_LAT(self._cmd_latency) |
@@ -665,8 +1068,28 @@ class MemoryTester(object):
 	CORE_REGS = {
 		'cmd': 0,
 		'addr': 1,
+		'seed': 2,
+		'err_cnt': 3,
+		'err_addr': 4,
+		'run': 5,
+		'pf_busy': 8,
+		'pf_stall': 9,
+		'pf_words': 10,
+		'pf_bursts': 11,
+		'pf_lat_sum': 12,
+		'pf_lat_n': 13,
+	}
+
+	PATTERNS = {
+		'buffer': 0,
+		'prbs': 1,
+		'addr': 2,
+		'walk': 3,
 	}
 
+	CMD_RUN			= 1 << 23
+	CMD_INVERT		= 1 << 22
+	CMD_PATTERN		= lambda self, p: self.PATTERNS[p] << 19
 	CMD_DUAL		= 1 << 18
 	CMD_CHECK_RST	= 1 << 17
 	CMD_READ		= 1 << 16
@@ -684,12 +1107,21 @@ class MemoryTester(object):
 	def _read(self, reg):
 		return self.intf.read(self.base + self.CORE_REGS[reg])
 
+	def _read_defer(self, reg):
+		return self.intf.read_defer(self.base + self.CORE_REGS[reg])
+
 	def ram_write(self, addr, val):
 		self.intf.write(self.base + 0x100 + addr, val)
 
 	def ram_read(self, addr):
 		return self.intf.read(self.base + 0x100 + addr)
 
+	def ram_write_block(self, addr, words):
+		self.intf.write_block(self.base + 0x100 + addr, words)
+
+	def ram_read_block(self, addr, n):
+		return self.intf.read_block(self.base + 0x100 + addr, n)
+
 	def cmd_write(self, ram_addr, buf_addr, xfer_len):
 		self._write('addr', ram_addr)
 		self._write('cmd',
@@ -708,16 +1140,88 @@ class MemoryTester(object):
 			self.CMD_LEN(xfer_len)
 		)
 
+	def cmd_run(self, ram_addr, n_bursts, read, pattern, invert=False, check_reset=False, burst_len=128):
+		self._write('addr', ram_addr)
+		self._write('run', n_bursts - 1)
+		self._write('cmd',
+			self.CMD_RUN |
+			(self.CMD_INVERT if invert else 0) |
+			self.CMD_PATTERN(pattern) |
+			(self.CMD_CHECK_RST if check_reset else 0) |
+			(self.CMD_READ if read else self.CMD_WRITE) |
+			self.CMD_LEN(burst_len)
+		)
+
+	def wait_run(self):
+		while self._read('cmd') & 4:
+			pass
+
+	def perf_clear(self):
+		self._write('pf_busy', 0)
+
+	def perf_read(self):
+		with self.intf.batch():
+			rv = { k: self._read_defer(k) for k in self.CORE_REGS.keys() if k.startswith('pf_') }
+		return { k[3:]: v.value for k, v in rv.items() }
+
+	def run_pattern(self, base, size, pattern='prbs', seed=None, invert=False):
+		"""Fills the [base, base+size) word range with a generated pattern
+		and checks it back, all done in hardware. Returns the number of
+		failed words and the address of the first one (or None)"""
+
+		# Check alignement
+		if (base & 127) or (size & 127):
+			raise ValueError('Base Address and Size argument for pattern testing must be aligned on 128-words')
+
+		# Seed
+		if seed is None:
+			seed = random.randint(0, (1<<32)-1)
+
+		self._write('seed', seed)
+
+		# Fill and check
+		self.cmd_run(base, size // 128, False, pattern, invert)
+		self.wait_run()
+
+		self.cmd_run(base, size // 128, True, pattern, invert, check_reset=True)
+		self.wait_run()
+
+		# Results
+		with self.intf.batch():
+			err_cnt  = self._read_defer('err_cnt')
+			err_addr = self._read_defer('err_addr')
+
+		if err_cnt.value == 0:
+			return 0, None
+
+		return err_cnt.value, err_addr.value
+
+	def run_patterns(self, base, size):
+		all_good = True
+
+		for pattern in ['prbs', 'addr', 'walk']:
+			for invert in [False, True]:
+				name = pattern + (' (inverted)' if invert else '')
+				err_cnt, err_addr = self.run_pattern(base, size, pattern, invert=invert)
+				if err_cnt:
+					print(" ! Pattern %-16s: %d errors, first @ %08x" % (name, err_cnt, err_addr))
+					all_good = False
+				else:
+					print(" . Pattern %-16s: OK" % (name,))
+
+		return all_good
+
 	def load_data(self, addr, data):
-		for base in range(0, len(data), 128):
-			# Upload chunk to RAM (128 bytes = max burst len)
-			for j in range(0, 128, 4):
-				b = (data[base+j:base+j+4] + b'\x00\x00\x00\x00')[0:4]
-				w = int.from_bytes(b, 'big')
-				self.ram_write(j // 4, w)
+		with self.intf.batch():
+			for base in range(0, len(data), 1024):
+				# Upload chunk to buffer (full 1k, padded to 128 bytes)
+				l = min(1024, (len(data) - base + 127) & ~127)
+				b = (data[base:base+l] + bytes(l))[0:l]
+				self.ram_write_block(0, [int.from_bytes(b[j:j+4], 'big') for j in range(0, l, 4)])
 
-			# Issue command to write chunk to RAM
-			self.cmd_write(addr + (base // 4), 0, 32)
+				# Write it to RAM as a run of 128 bytes bursts, which
+				# consumes the buffer sequentially
+				self.cmd_run(addr + (base // 4), l // 128, False, 'buffer', burst_len=32)
 
 	def run(self, base, size):
 		# Check alignement
@@ -730,28 +1234,36 @@ class MemoryTester(object):
 				for i in range(256)
 		]
 
-		for i in range(256):
-			self.ram_write(i, ref_data[i])
+		self.ram_write_block(0, ref_data)
 
 		# Fill memory
-		for addr in range(base, base+size, 32):
-			print(" . Writing block @ %08x\r" % (addr,), end='')
-			self.cmd_write(addr, addr & 0xff, 32)
+		with self.intf.batch():
+			for addr in range(base, base+size, 32):
+				if (addr & 0xfff) == 0:
+					print(" . Writing block @ %08x\r" % (addr,), end='')
+				self.cmd_write(addr, addr & 0xff, 32)
 
 		# Validate all blocks
+		# (status reads are queued and only checked once the batch is sent)
 		all_good = True
+		status = []
 
-		for addr in range(base, base+size, 32):
-			blk_first = (addr & 0xfff) == 0x000
-			blk_last  = (addr & 0xfff) == 0xfe0
+		with self.intf.batch():
+			for addr in range(base, base+size, 32):
+				blk_first = (addr & 0xfff) == 0x000
+				blk_last  = (addr & 0xfff) == 0xfe0
 
-			print(" . Reading block @ %08x\r" % (addr,), end='')
-			self.cmd_read(addr, addr & 0xff, 32, check_reset=blk_first)
+				if blk_first:
+					print(" . Reading block @ %08x\r" % (addr,), end='')
+				self.cmd_read(addr, addr & 0xff, 32, check_reset=blk_first)
 
-			if blk_last:
-				if not (self._read('cmd') & 2):
-					print(" ! Failed at block %08x" % (addr,))
-					all_good = False
+				if blk_last:
+					status.append( (addr, self._read_defer('cmd')) )
+
+		for addr, st in status:
+			if not (st.value & 2):
+				print(" ! Failed at block %08x" % (addr,))
+				all_good = False
 
 		print("                                    \r", end='')
 
@@ -774,17 +1286,79 @@ class HDMIOutput(object):
 	def _read(self, reg):
 		return self.intf.read(self.base + self.CORE_REGS[reg])
 
+	FORMATS = {
+		'4bpp': 0,
+		'8bpp': 1,
+		'tile': 2,
+	}
+
+	# Memory words per line for the raw formats (tile lines use a slot
+	# size picked by the encoder)
+	LINE_WORDS = {
+		'4bpp': 1920 // 8,
+		'8bpp': 1920 // 4,
+	}
+
+	# Fixed 1080p60 timing
+	FRAME_RATE = 60
+
 	def pal_write(self, addr, val):
-		self.intf.write(self.base + (1<<6) + addr, val)
+		self.intf.write(self.base + (1<<8) + addr, val)
+
+	def pal_load_rgb332(self):
+		"""RGB332 is just 8bpp with a fixed palette. Palette entries are
+		B in [11:8], G in [7:4], R in [3:0] so this only makes sense with
+		a VIDEO=12bpp bitstream (with 4bpp output, only [3:0] is kept)"""
+		with self.intf.batch():
+			for i in range(256):
+				r = ((i >> 5) & 7) * 15 // 7
+				g = ((i >> 2) & 7) * 15 // 7
+				b = ((i >> 0) & 3) * 5
+				self.pal_write(i, (b << 8) | (g << 4) | r)
+
+	@staticmethod
+	def tile_encode(img, width=1920):
+		"""Encodes a 4bpp image (one pixel per byte) in the tile format.
+		Groups of 4 pixels with more than 2 colors are lossy (extra colors
+		map to the first pixel's one). Returns (data, line_words)"""
+		lines = []
+
+		for y in range(0, len(img), width):
+			tiles = []
+			for x in range(y, y + width, 4):
+				g = img[x:x+4]
+				c0 = g[0]
+				c1 = max(set(g), key=lambda c: (c != c0, g.count(c)))
+				mask = sum([8 >> i for i in range(4) if g[i] == c1 and c1 != c0])
+				t = (c0 << 12) | (c1 << 8) | (mask << 4)
+
+				if tiles and ((tiles[-1] & 0xfff0) == t) and ((tiles[-1] & 0xf) != 0xf):
+					tiles[-1] += 1
+				else:
+					tiles.append(t)
+			lines.append(tiles)
+
+		# Each line gets a fixed size slot, big enough for the worst one
+		line_words = (max([len(t) for t in lines]) + 1) // 2
+
+		data = bytearray()
+		for tiles in lines:
+			tiles = tiles + [0] * (2 * line_words - len(tiles))
+			data.extend(b''.join([t.to_bytes(2, 'big') for t in tiles]))
+
+		return bytes(data), line_words
+
+	def _config(self, fb_addr, burst_len, fmt, line_words):
+		# Format
+		self.intf.write(self.base + 2, self.FORMATS[fmt])
 
-	def enable(self, fb_addr, burst_len):
 		# Frame Buffer address
 		self.intf.write(self.base + 1, fb_addr)
 
 		# Burst Config
-		bn_cnt = ((1920 // 8) - 1) // burst_len
+		bn_cnt = (line_words - 1) // burst_len
 		bn_len = burst_len - 1
-		bl_len = (1920 // 8) - (burst_len * bn_cnt) - 1
+		bl_len = line_words - (burst_len * bn_cnt) - 1
 		bl_inc = bl_len
 
 		self.intf.write(self.base + 0,
@@ -795,5 +1369,76 @@ class HDMIOutput(object):
 			(bl_inc <<  0)
 		)
 
+	def uf_clear(self):
+		self.intf.write(self.base + 3, 0)
+
+	def uf_read(self):
+		"""Returns (frames, frames with underflows, lines that underflowed
+		in the last frame) since the last clear"""
+		with self.intf.batch():
+			r3 = self.intf.read_defer(self.base + 3)
+			r4 = self.intf.read_defer(self.base + 4)
+		return (r3.value & 0xffff, r3.value >> 16, r4.value)
+
+	def _uf_wait_frames(self, n_frames):
+		# Frame counter only advances if the core is there (and the
+		# video timing running), so don't wait forever
+		t_end = time.time() + 1.0 + 2.0 * n_frames / self.FRAME_RATE
+		self.uf_clear()
+		while True:
+			frames, bad, lines = self.uf_read()
+			if frames >= n_frames:
+				return frames, bad
+			if time.time() > t_end:
+				raise RuntimeError('HDMI frame counter not advancing (bitstream built with VIDEO=none ?)')
+			time.sleep(0.02)
+
+	def uf_wait(self, n_frames):
+		# Let the frame in progress during the config change finish,
+		# then count from a fresh clear. The first frame counted is
+		# partial but only has lines fetched with the new config.
+		self._uf_wait_frames(1)
+		frames, bad = self._uf_wait_frames(n_frames + 1)
+		return frames - 1, bad
+
+	def tune(self, fb_addr, fmt='4bpp', line_words=None, n_frames=30, verbose=True):
+		"""Tries burst lengths from the largest down and returns the first
+		one that ran 'n_frames' frames without any underflow (or the one
+		with the least underflows if none did). Only meaningful with the
+		rest of the memory traffic running as it will be in use"""
+		if line_words is None:
+			line_words = self.LINE_WORDS[fmt]
+
+		# Max burst is 128 words, max 128 bursts per line
+		candidates = [ 1 << i for i in range(7, -1, -1) if ((line_words - 1) >> i) < 128 ]
+		best = None
+
+		for burst_len in candidates:
+			self._config(fb_addr, burst_len, fmt, line_words)
+			frames, bad = self.uf_wait(n_frames)
+
+			if verbose:
+				print(" burst %3d : %d / %d frames with underflows" % (burst_len, bad, frames))
+
+			if (best is None) or (bad < best[1]):
+				best = (burst_len, bad)
+
+			if bad == 0:
+				break
+		else:
+			if verbose:
+				print("[!] No stable burst length, using %d" % (best[0],))
+
+		return best[0]
+
+	def enable(self, fb_addr, burst_len=None, fmt='4bpp', line_words=None):
+		if line_words is None:
+			line_words = self.LINE_WORDS[fmt]
+
+		if burst_len is None:
+			burst_len = self.tune(fb_addr, fmt, line_words)
+
+		self._config(fb_addr, burst_len, fmt, line_words)
+
 	def disable(self):
 		self.intf.write(self.base + 0, 0)
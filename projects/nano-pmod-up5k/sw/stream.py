@@ -4,7 +4,7 @@ import argparse
 import struct
 import time
 
-from pycrc.algorithms import Crc
+import numpy as np
 
 import control
 
@@ -15,7 +15,18 @@ import control
 
 EOTP = bytearray([ 0x08, 0x0f, 0x0f, 0x01 ])
 
-DSI_CRC = Crc(width=16, poly=0x1021, xor_in=0xffff, xor_out=0x0000, reflect_in=True, reflect_out=True)
+
+def _dsi_crc_table():
+	# CRC-16 CCITT, reflected (poly 0x8408), one entry per input byte
+	tbl = []
+	for i in range(256):
+		c = i
+		for j in range(8):
+			c = (c >> 1) ^ (0x8408 if (c & 1) else 0)
+		tbl.append(c)
+	return tbl
+
+DSI_CRC_TABLE = _dsi_crc_table()
 
 
 def parity(x):
@@ -38,7 +49,10 @@ def dsi_header(*data):
 
 
 def dsi_crc(payload):
-	crc = DSI_CRC.bit_by_bit(bytes(payload))
+	crc = 0xffff
+	tbl = DSI_CRC_TABLE
+	for b in payload:
+		crc = (crc >> 8) ^ tbl[(crc ^ b) & 0xff]
 	return bytearray([ crc & 0xff, (crc >> 8) & 0xff ])
 
 
@@ -94,6 +108,10 @@ class DSIControl(control.BoardControlBase):
 		self.flip_page = flip_page
 		self.transpose = transpose
 
+		# Delta update state
+		self._prev_frame = None
+		self._win_full = True
+
 		# Init the LCD
 		self.init()
 
@@ -227,7 +245,92 @@ class DSIControl(control.BoardControlBase):
 				b'\x00'
 			)
 
+	def _send_region(self, data, w, bpp):
+		# Max packet size (whole lines of the region if possible)
+		mtu = 1024 - 4 - 1 - 2
+		lsz = 2 * w
+		psz = (mtu // lsz) * lsz if lsz <= mtu else (mtu & ~1)
+
+		# Total size (in 16 bit format)
+		tsz = len(data) * 16 // bpp
+
+		for ofs in range(0, tsz, psz):
+			l = min(psz, tsz - ofs)
+			hdr = dsi_header(0x39, (l + 1) & 0xff, (l + 1) >> 8) + (b'\x2c' if ofs == 0 else b'\x3c')
+
+			if bpp == 16:
+				self.send_dsi_pkt(hdr + data[ofs:ofs+l] + b'\x00\x00')
+			else:
+				self.reg_burst(self.REG_PKT_WR_DATA_U8, hdr + data[ofs//2:(ofs+l)//2] + b'\x00')
+
+	def _set_window_full(self):
+		if not self._win_full:
+			self.set_column_address(0, self.n_col  - 1)
+			self.set_page_address (0, self.n_page - 1)
+			self._win_full = True
+
+	def send_frame_delta(self, frame, bpp=16, gap=8, max_ratio=0.75):
+		with self.batch():
+			self._send_frame_delta(frame, bpp, gap, max_ratio)
+
+	def _send_frame_delta(self, frame, bpp, gap, max_ratio):
+		# Only supported without manual transpose
+		if self.transpose == DSIControl.TRANSPOSE_MANUAL:
+			return self._send_frame(frame, bpp)
+
+		# Compare with previous frame
+		cur = np.frombuffer(frame, dtype=(np.uint16 if bpp == 16 else np.uint8), count=self.n_col * self.n_page)
+		cur = cur.reshape(self.n_page, self.n_col)
+
+		prev = self._prev_frame
+		self._prev_frame = cur.copy()
+
+		if (prev is None) or (prev.dtype != cur.dtype):
+			return self._send_frame(frame, bpp)
+
+		diff = cur != prev
+
+		# Group changed pages into spans, merging small gaps
+		pages = np.flatnonzero(diff.any(axis=1))
+		if not len(pages):
+			return
+
+		spans = []
+		sp = ep = int(pages[0])
+		for y in pages[1:]:
+			y = int(y)
+			if (y - ep) > gap:
+				spans.append((sp, ep))
+				sp = y
+			ep = y
+		spans.append((sp, ep))
+
+		# Column range of each span
+		rects = []
+		area  = 0
+		for sp, ep in spans:
+			cols = np.flatnonzero(diff[sp:ep+1].any(axis=0))
+			sc, ec = int(cols[0]), int(cols[-1])
+			rects.append((sc, ec, sp, ep))
+			area += (ec - sc + 1) * (ep - sp + 1)
+
+		# If most of the screen changed, full frame is cheaper
+		if area > max_ratio * self.n_col * self.n_page:
+			return self._send_frame(frame, bpp)
+
+		# Send each region
+		for sc, ec, sp, ep in rects:
+			self.set_column_address(sc, ec)
+			self.set_page_address(sp, ep)
+			self._send_region(cur[sp:ep+1, sc:ec+1].tobytes(), ec - sc + 1, bpp)
+
+		self._win_full = False
+
 	def send_frame(self, frame, bpp=16):
+		with self.batch():
+			self._send_frame(frame, bpp)
+
+	def _send_frame(self, frame, bpp):
 		# Delegate depending on config
 		if self.transpose == DSIControl.TRANSPOSE_MANUAL:
 			# Init the command tables
@@ -245,6 +348,7 @@ class DSIControl(control.BoardControlBase):
 				self._send_frame_transpose_16b(frame)
 
 		else:
+			self._set_window_full()
 			self._send_frame_normal(frame, bpp)
 
 
@@ -253,23 +357,29 @@ class DSIControl(control.BoardControlBase):
 # ---------------------------------------------------------------------------
 
 
-def load_bgr888_as_bgr565(filename):
-	img = open(filename,'rb').read()
-	dat = []
+def _bgrx_split(data):
+	# Input is 32 bits per pixel, B/G/R/x byte order
+	px = np.frombuffer(data, dtype=np.uint8)
+	px = px[:(len(px) // 4) * 4].reshape(-1, 4).astype(np.uint16)
+	return px[:,0], px[:,1], px[:,2]
 
-	for i in range(len(img) // 4):
-		b = img[4*i + 0]
-		g = img[4*i + 1]
-		r = img[4*i + 2]
 
-		c  = ((r >> 3) & 0x1f) << 11;
-		c |= ((g >> 2) & 0x3f) <<  5;
-		c |= ((b >> 3) & 0x1f) <<  0;
+def bgr888_to_bgr565(data):
+	b, g, r = _bgrx_split(data)
+	c = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+	return c.astype('<u2').tobytes()
 
-		dat.append( ((c >> 0) & 0xff) )
-		dat.append( ((c >> 8) & 0xff) )
 
-	return bytearray(dat)
+def bgr888_to_bgr8(data):
+	# 8 bit format expanded by the gateware: [7:6] R, [5:3] G, [2:0] B
+	b, g, r = _bgrx_split(data)
+	c = ((r >> 6) << 6) | ((g >> 5) << 3) | (b >> 5)
+	return c.astype(np.uint8).tobytes()
+
+
+def load_bgr888_as_bgr565(filename):
+	with open(filename, 'rb') as fh:
+		return bytearray(bgr888_to_bgr565(fh.read()))
 
 
 def main():
@@ -285,6 +395,8 @@ def main():
 	g_input.add_argument('--fps',   type=float, help='Target FPS to regulate to (None=no regulation)')
 	g_input.add_argument('--loop',  help='Play in a loop', action='store_true', default=False)
 	g_input.add_argument('--bgr8',  help='Input is BGR8 instead of BGR565', action='store_true', default=False)
+	g_input.add_argument('--delta', help='Only send the changed regions of each frame', action='store_true', default=False)
+	g_input.add_argument('--bgrx',  help='Input is BGRx8888, converted on the fly to BGR565 (or BGR8)', action='store_true', default=False)
 
 	g_display.add_argument('--n_col',     type=int, metavar='N', help='Number of columns', default=240)
 	g_display.add_argument('--n_page',    type=int, metavar='N', help='Number of pages',   default=240)
@@ -311,32 +423,28 @@ def main():
 	ctrl = DSIControl(**kwargs)
 
 	# Streaming loop
-	if args.fps:
-		tpf = 1.0 / args.fps
-		tt  = time.time() + tpf
+	if args.bgrx:
+		fbpp = 4
+		conv = bgr888_to_bgr8 if args.bgr8 else bgr888_to_bgr565
+	else:
+		fbpp = 1 if args.bgr8 else 2
+		conv = None
 
-	fsize = args.n_col * args.n_page * (1 if args.bgr8 else 2)
+	reader = control.FrameReader(args.input,
+		frame_size = args.n_col * args.n_page * fbpp,
+		loop = args.loop,
+		convert = conv,
+	)
+	pacer = control.FramePacer(args.fps)
 
-	while True:
-		# Send one frame
-		data = args.input.read(fsize)
-		if len(data) == fsize:
-			ctrl.send_frame(data, bpp=(8 if args.bgr8 else 16))
+	send = ctrl.send_frame_delta if args.delta else ctrl.send_frame
 
-		# Loop ?
-		else:
-			if args.loop:
-				args.input.seek(0)
-				continue
-			else:
-				break
+	for frame in reader:
+		# Send one frame
+		send(frame, bpp=(8 if args.bgr8 else 16))
 
 		# FPS regulation
-		if args.fps:
-			w = tt - time.time()
-			if w > 0:
-				time.sleep(w)
-			tt += tpf
+		pacer.wait()
 
 
 if __name__ == '__main__':
@@ -80,6 +80,12 @@ module vstream #(
 	wire [7:0] sb_out;
 
 	// Front Buffer write
+	wire burst;
+	wire burst_hdr;
+	wire px_stb;
+	wire line_end;
+	reg  [LOG_N_ROWS-1:0] burst_row;
+
 	reg [TW-1:0] trig;
 	reg [LOG_N_COLS-1:0] cnt_col;
 	reg [7:0] sb_data_r[0:1];
@@ -117,13 +123,28 @@ module vstream #(
 
 	// Front-Buffer write
 	// ------------------
+	//
+	// 0x80 : Single line write. Payload is the pixel data for one line that
+	//        then needs to be stored using the 0x01/0x02/0x08 commands
+	//
+	// 0xc0 : Multi-line burst. First payload byte is the start row, then
+	//        pixel data for any number of lines. Each complete line is
+	//        automatically stored & swapped, and the row incremented.
+	//
+
+	// Burst mode
+	assign burst     = sb_addr[7] & sb_addr[6];
+	assign burst_hdr = sb_stb & burst & sb_first;
+
+	// Pixel data strobe
+	assign px_stb = sb_stb & ~burst_hdr;
 
 	// "Trigger"
 	always @(posedge clk or posedge rst)
 		if (TW > 1) begin
 			if (rst)
 				trig <= { 1'b1, {(TW-1){1'b0}} };
-			else if (sb_stb)
+			else if (px_stb)
 				trig <= sb_last ? { 1'b1, {(TW-1){1'b0}} } : { trig[0], trig[TW-1:1] };
 		end else
 			trig <= 1'b1;
@@ -132,8 +153,18 @@ module vstream #(
 	always @(posedge clk or posedge rst)
 		if (rst)
 			cnt_col <= 0;
-		else if (sb_stb)
-			cnt_col <= sb_last ? 0 : (cnt_col + trig[0]);
+		else if (px_stb)
+			cnt_col <= (sb_last | line_end) ? 0 : (cnt_col + trig[0]);
+
+	// Last pixel of a line
+	assign line_end = fbw_wren & (cnt_col == (N_COLS - 1));
+
+	// Row counter for burst mode
+	always @(posedge clk)
+		if (burst_hdr)
+			burst_row <= sb_data[LOG_N_ROWS-1:0];
+		else if (burst & fbw_row_store)
+			burst_row <= burst_row + 1;
 
 	// Register data for wide writes
 	always @(posedge clk)
@@ -143,7 +174,7 @@ module vstream #(
 		end
 
 	// Write commands
-	assign fbw_wren = sb_stb & sb_addr[7] & trig[0];
+	assign fbw_wren = px_stb & sb_addr[7] & trig[0];
 	assign fbw_col_addr = cnt_col;
 
 	// Map to color
@@ -161,7 +192,7 @@ module vstream #(
 	// -----------------
 
 	// Direct commands
-	assign fbw_row_addr  = sb_data[LOG_N_ROWS-1:0];
+	assign fbw_row_addr  = burst ? burst_row : sb_data[LOG_N_ROWS-1:0];
 	assign fbw_row_store = (sb_stb & sb_first & ~sb_addr[7] & sb_addr[0]) | (fbw_row_rdy & store_swap_pending);
 	assign fbw_row_swap  = (sb_stb & sb_first & ~sb_addr[7] & sb_addr[1]) | (fbw_row_rdy & store_swap_pending);
 
@@ -170,7 +201,7 @@ module vstream #(
 		if (rst)
 			store_swap_pending <= 1'b0;
 		else
-			store_swap_pending <= (store_swap_pending & ~fbw_row_rdy) | (sb_stb & sb_first & ~sb_addr[7] & sb_addr[3]);
+			store_swap_pending <= (store_swap_pending & ~fbw_row_rdy) | (sb_stb & sb_first & ~sb_addr[7] & sb_addr[3]) | (burst & line_end);
 
 	// Error tracking
 	assign err =
@@ -1,14 +1,13 @@
 #!/usr/bin/env python3
 
 import argparse
-import time
 
 import control
 
 
 class PanelControl(control.BoardControlBase):
 
-	def __init__(self, n_banks=2, n_rows=32, n_cols=64, colordepth=16, **kwargs):
+	def __init__(self, n_banks=2, n_rows=32, n_cols=64, colordepth=16, burst_lines=0, **kwargs):
 		# Super call
 		super().__init__(**kwargs)
 
@@ -23,20 +22,64 @@ class PanelControl(control.BoardControlBase):
 		self.send_buf = bytearray(1 + self.line_bytes)
 		self.send_buf_view = memoryview(self.send_buf)
 
+		# Multi-line burst config (None = legacy line by line, 0 = full frame)
+		self.n_lines = n_banks * n_rows
+		self.burst_lines = burst_lines
+
+		if (self.burst_lines is not None) and (self.burst_lines <= 0):
+			self.burst_lines = self.n_lines
+
+		if self.burst_lines is not None:
+			self.burst_buf = bytearray(2 + self.burst_lines * self.line_bytes)
+			self.burst_buf_view = memoryview(self.burst_buf)
+
 	def send_line_file(self, fh):
 		self.send_buf_view[0] = 0x80
 		rb = fh.readinto(self.send_buf_view[1:])
 		if rb != self.line_bytes:
 			return False
-		self.slave.exchange(self.send_buf)
+		self.spi_write(self.send_buf)
 		return True
 
 	def send_line_data(self, data):
 		self.send_buf_view[0] = 0x80
 		self.send_buf_view[1:] = data
-		self.slave.exchange(self.send_buf)
+		self.spi_write(self.send_buf)
+
+	def send_burst_file(self, fh, y, n):
+		self.burst_buf_view[0] = 0xc0
+		self.burst_buf_view[1] = y
+		l = n * self.line_bytes
+		rb = fh.readinto(self.burst_buf_view[2:2+l])
+		if rb != l:
+			return False
+		self.spi_write(self.burst_buf_view[0:2+l])
+		return True
+
+	def send_burst_data(self, data, y, n):
+		self.burst_buf_view[0] = 0xc0
+		self.burst_buf_view[1] = y
+		l = n * self.line_bytes
+		self.burst_buf_view[2:2+l] = data
+		self.spi_write(self.burst_buf_view[0:2+l])
+
+	def frame_swap(self):
+		# Send frame swap command
+		self.reg_w8(0x04, 0x00)
+
+		# Wait for the frame swap to occur
+		while (self.read_status() & 0x02 == 0):
+			pass
 
 	def send_frame_file(self, fh):
+		# Multi-line bursts
+		if self.burst_lines is not None:
+			for y in range(0, self.n_lines, self.burst_lines):
+				if not self.send_burst_file(fh, y, min(self.burst_lines, self.n_lines - y)):
+					return False
+			self.frame_swap()
+			return True
+
 		# Scan all line
 		for y in range(self.n_banks * self.n_rows):
 			# Send write command to line buffer
@@ -46,19 +89,27 @@ class PanelControl(control.BoardControlBase):
 			# Swap line buffer & Write it to line y of back frame buffer
 			self.reg_w8(0x03, y)
 
-		# Send frame swap command
-		self.reg_w8(0x04, 0x00)
-
-		# Wait for the frame swap to occur
-		while (self.read_status() & 0x02 == 0):
-			pass
+		# Swap
+		self.frame_swap()
 
 		return True
 
 	def send_frame_data(self, frame):
+		with self.batch():
+			self._send_frame_data(frame)
+
+	def _send_frame_data(self, frame):
 		# View on the data
 		frame_view = memoryview(frame)
 
+		# Multi-line bursts
+		if self.burst_lines is not None:
+			for y in range(0, self.n_lines, self.burst_lines):
+				n = min(self.burst_lines, self.n_lines - y)
+				self.send_burst_data(frame_view[y*self.line_bytes:(y+n)*self.line_bytes], y, n)
+			self.frame_swap()
+			return
+
 		# Scan all line
 		for y in range(self.n_banks * self.n_rows):
 			# Send write command to line buffer
@@ -67,12 +118,8 @@ class PanelControl(control.BoardControlBase):
 			# Swap line buffer & Write it to line y of back frame buffer
 			self.reg_w8(0x03, y)
 
-		# Send frame swap command
-		self.reg_w8(0x04, 0x00)
-
-		# Wait for the frame swap to occur
-		while (self.read_status() & 0x02 == 0):
-			pass
+		# Swap
+		self.frame_swap()
 
 
 def main():
@@ -92,6 +139,7 @@ def main():
 	g_panel.add_argument('--n_rows',     type=int, metavar='N', help='Number of rows',    default=32)
 	g_panel.add_argument('--n_cols',     type=int, metavar='N', help='Number of columns', default=64)
 	g_panel.add_argument('--colordepth', type=int, metavar='DEPTH', help='Bit per color',     default=16)
+	g_panel.add_argument('--burst',      type=int, metavar='N', help='Lines per SPI burst (0=full frame, -1=line by line for older bitstreams)', default=0)
 
 	control.arg_group_setup(g_brd)
 
@@ -103,32 +151,23 @@ def main():
 	kwargs['n_rows']     = args.n_rows
 	kwargs['n_cols']     = args.n_cols
 	kwargs['colordepth'] = args.colordepth
+	kwargs['burst_lines'] = args.burst if args.burst >= 0 else None
 
 	panel = PanelControl(**kwargs)
 
 	# Streaming loop
-	if args.fps:
-		tpf = 1.0 / args.fps
-		tt  = time.time() + tpf
+	reader = control.FrameReader(args.input,
+		frame_size = args.n_banks * args.n_rows * panel.line_bytes,
+		loop = args.loop,
+	)
+	pacer = control.FramePacer(args.fps)
 
-	while True:
+	for frame in reader:
 		# Send one frame
-		rv = panel.send_frame_file(args.input)
-
-		# Loop ?
-		if not rv:
-			if args.loop:
-				args.input.seek(0)
-				continue
-			else:
-				break
+		panel.send_frame_data(frame)
 
 		# FPS regulation
-		if args.fps:
-			w = tt - time.time()
-			if w > 0:
-				time.sleep(w)
-			tt += tpf
+		pacer.wait()
 
 
 if __name__ == '__main__':
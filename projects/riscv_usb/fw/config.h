@@ -28,3 +28,4 @@
 #define LED_BASE	0x83000000
 #define USB_CORE_BASE	0x84000000
 #define USB_DATA_BASE	0x85000000
+#define PERF_BASE	0x86000000
@@ -28,6 +28,7 @@
 #include "console.h"
 #include "led.h"
 #include "mini-printf.h"
+#include "perf.h"
 #include "spi.h"
 #include <no2usb/usb.h>
 #include <no2usb/usb_dfu_rt.h>
@@ -68,6 +69,44 @@ boot_dfu(void)
 	*boot = (1 << 2) | (1 << 0);
 }
 
+/* Benchmark marker : writes to this address are ignored by the hardware
+ * but sim/top_tb.v reports the cycles elapsed between a 'start' (bit 0 = 0)
+ * and 'end' (bit 0 = 1) marker with the same ID (upper bits) */
+static volatile uint32_t * const bench_mark = (void*)0x80000004;
+
+static void
+bench_printf(void)
+{
+	static const char * const fmts[] = { "%08x", "%d", "%u" };
+	static const uint32_t values[] = {
+		0, 9, 1234, 0xdeadbeef, 0x7fffffff, 0xffffffff,
+	};
+	uint32_t cyc[4];
+	char buf[16];
+	int i, j;
+
+	/* snprintf, 6 conversions per format */
+	for (i=0; i<3; i++) {
+		*bench_mark = (i << 1) | 0;
+		cyc[i] = perf_cycles();
+		for (j=0; j<6; j++)
+			snprintf(buf, sizeof(buf), fmts[i], values[j]);
+		cyc[i] = perf_cycles() - cyc[i];
+		*bench_mark = (i << 1) | 1;
+	}
+
+	/* hexstr, 24 bytes */
+	*bench_mark = (3 << 1) | 0;
+	cyc[3] = perf_cycles();
+	hexstr((void*)values, sizeof(values), true);
+	cyc[3] = perf_cycles() - cyc[3];
+	*bench_mark = (3 << 1) | 1;
+
+	for (i=0; i<3; i++)
+		printf("snprintf(\"%s\") : %d cycles / conversion\n", fmts[i], cyc[i] / 6);
+	printf("hexstr(24 bytes) : %d cycles\n", cyc[3]);
+}
+
 void
 usb_dfu_rt_cb_reboot(void)
 {
@@ -89,6 +128,11 @@ void main()
 	led_breathe(true, 100, 200);
 	led_state(true);
 
+#ifdef BENCH
+	/* Formatting benchmark (see sim/top_tb.v) */
+	bench_printf();
+#endif
+
 	/* SPI */
 	spi_init();
 
@@ -119,6 +163,9 @@ void main()
 			case 'p':
 				usb_debug_print();
 				break;
+			case 'f':
+				bench_printf();
+				break;
 			case 'b':
 				boot_dfu();
 				break;
@@ -51,12 +51,40 @@ mini_strlen(const char *s)
 	return len;
 }
 
+/* Divide by 10 using only shifts and adds (Hacker's Delight, divu10).
+ * The target is rv32i without M extension, so a plain '/' or '%' would
+ * end up as a libgcc __udivsi3 / __umodsi3 call for every digit. */
+static unsigned int
+mini_divu10(unsigned int n, unsigned int *rem)
+{
+	unsigned int q, r;
+
+	q = (n >> 1) + (n >> 2);
+	q = q + (q >> 4);
+	q = q + (q >> 8);
+	q = q + (q >> 16);
+	q = q >> 3;
+	r = n - (((q << 2) + q) << 1);
+
+	if (r > 9) {
+		q++;
+		r -= 10;
+	}
+
+	*rem = r;
+	return q;
+}
+
 static unsigned int
 mini_itoa(int value, unsigned int radix, unsigned int uppercase, unsigned int unsig,
 	 char *buffer, unsigned int zero_pad)
 {
+	static const char digits_lc[] = "0123456789abcdef";
+	static const char digits_uc[] = "0123456789ABCDEF";
+	const char *digits = uppercase ? digits_uc : digits_lc;
 	char	*pbuffer = buffer;
 	int	negative = 0;
+	unsigned int	v = value;
 	unsigned int	i, len;
 
 	/* No support for unusual radixes. */
@@ -65,15 +93,30 @@ mini_itoa(int value, unsigned int radix, unsigned int uppercase, unsigned int un
 
 	if (value < 0 && !unsig) {
 		negative = 1;
-		value = -value;
+		v = -v;
 	}
 
 	/* This builds the string back to front ... */
-	do {
-		int digit = value % radix;
-		*(pbuffer++) = (digit < 10 ? '0' + digit : (uppercase ? 'A' : 'a') + digit - 10);
-		value /= radix;
-	} while (value > 0);
+	if (radix == 16) {
+		/* Hex: shift / mask only */
+		do {
+			*(pbuffer++) = digits[v & 0xf];
+			v >>= 4;
+		} while (v);
+	} else if (radix == 10) {
+		/* Decimal: shift / add division */
+		do {
+			unsigned int digit;
+			v = mini_divu10(v, &digit);
+			*(pbuffer++) = '0' + digit;
+		} while (v);
+	} else {
+		/* Anything else: generic (slow) path */
+		do {
+			*(pbuffer++) = digits[v % radix];
+			v /= radix;
+		} while (v);
+	}
 
 	for (i = (pbuffer - buffer); i < zero_pad; i++)
 		*(pbuffer++) = '0';
@@ -0,0 +1,101 @@
+/*
+ * perf.c
+ *
+ * Copyright (C) 2020 Sylvain Munaut
+ * All rights reserved.
+ *
+ * LGPL v3+, see LICENSE.lgpl3
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "config.h"
+#include "console.h"
+#include "perf.h"
+
+
+struct wb_perf {
+	uint32_t csr;
+	uint32_t cycles;
+	uint32_t access;
+	uint32_t wait;
+} __attribute__((packed,aligned(4)));
+
+#define PERF_CSR_CLEAR		(1 << 31)
+
+static volatile struct wb_perf * const perf_regs = (void*)(PERF_BASE);
+
+
+void
+perf_init(uint32_t slave_mask)
+{
+	perf_regs->csr = PERF_CSR_CLEAR | slave_mask;
+}
+
+void
+perf_clear(void)
+{
+	perf_regs->csr = PERF_CSR_CLEAR | perf_regs->csr;
+}
+
+uint32_t
+perf_cycles(void)
+{
+	return perf_regs->cycles;
+}
+
+
+void
+perf_begin(struct perf_snap *snap)
+{
+	snap->acc  = perf_regs->access;
+	snap->wait = perf_regs->wait;
+	snap->cyc  = perf_regs->cycles;
+}
+
+void
+perf_end(struct perf_stat *stat, const struct perf_snap *snap)
+{
+	uint32_t cyc = perf_regs->cycles - snap->cyc;
+
+	stat->n++;
+	stat->cyc_sum  += cyc;
+	stat->acc_sum  += perf_regs->access - snap->acc;
+	stat->wait_sum += perf_regs->wait   - snap->wait;
+
+	if (cyc > stat->cyc_max)
+		stat->cyc_max = cyc;
+}
+
+
+void
+perf_stat_reset(struct perf_stat *stat)
+{
+	const char *name = stat->name;
+	memset(stat, 0x00, sizeof(struct perf_stat));
+	stat->name = name;
+}
+
+void
+perf_stat_print(const struct perf_stat *stat)
+{
+	printf("%s: n=%u cyc=%u max=%u acc=%u wait=%u\n",
+		stat->name, stat->n, stat->cyc_sum, stat->cyc_max,
+		stat->acc_sum, stat->wait_sum
+	);
+}
@@ -0,0 +1,67 @@
+/*
+ * perf.h
+ *
+ * Copyright (C) 2020 Sylvain Munaut
+ * All rights reserved.
+ *
+ * LGPL v3+, see LICENSE.lgpl3
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Monitored slaves mask : bit N is the wishbone slave at 0x8N000000 */
+#define PERF_SLAVE(n)	(1 << (n))
+
+struct perf_stat {
+	const char *name;
+	uint32_t n;
+	uint32_t cyc_sum;
+	uint32_t cyc_max;
+	uint32_t acc_sum;
+	uint32_t wait_sum;
+};
+
+struct perf_snap {
+	uint32_t cyc;
+	uint32_t acc;
+	uint32_t wait;
+};
+
+void perf_init(uint32_t slave_mask);
+void perf_clear(void);
+uint32_t perf_cycles(void);
+
+void perf_begin(struct perf_snap *snap);
+void perf_end(struct perf_stat *stat, const struct perf_snap *snap);
+
+void perf_stat_reset(struct perf_stat *stat);
+void perf_stat_print(const struct perf_stat *stat);
+
+/* Scoped timing helper :
+ *
+ *   static struct perf_stat ps_foo = { .name = "foo" };
+ *   PERF_SCOPE(&ps_foo) {
+ *     foo();
+ *   }
+ */
+#define PERF_SCOPE(stat) \
+	for (struct perf_snap __ps_snap, *__ps_once = (perf_begin(&__ps_snap), &__ps_snap); \
+	     __ps_once; \
+	     perf_end((stat), &__ps_snap), __ps_once = NULL)
@@ -25,4 +25,15 @@
 
 #include <stdbool.h>
 
+#include "config.h"
+
+/* Place hot code / data in the zero wait-state EBR memory if the SoC has one */
+#ifdef FASTRAM_BASE
+# define __fast_text	__attribute__((section(".fast.text"),noinline))
+# define __fast_data	__attribute__((section(".fast.data")))
+#else
+# define __fast_text
+# define __fast_data
+#endif
+
 char *hexstr(void *d, int n, bool space);
@@ -40,7 +40,7 @@ module top (
 );
 
 	localparam integer SPRAM_AW = 14; /* 14 => 64k, 15 => 128k */
-	localparam integer WB_N  =  6;
+	localparam integer WB_N  =  7;
 
 	localparam integer WB_DW = 32;
 	localparam integer WB_AW = 16;
@@ -192,6 +192,25 @@ module top (
 	assign wb_rdata[5] = 0;
 
 
+	// Perf counters [6]
+	// -------------
+
+	soc_perf #(
+		.WB_N(WB_N)
+	) perf_I (
+		.mon_cyc  (wb_cyc),
+		.mon_ack  (wb_ack),
+		.wb_addr  (wb_addr[1:0]),
+		.wb_rdata (wb_rdata[6]),
+		.wb_wdata (wb_wdata),
+		.wb_we    (wb_we),
+		.wb_cyc   (wb_cyc[6]),
+		.wb_ack   (wb_ack[6]),
+		.clk      (clk_24m),
+		.rst      (rst)
+	);
+
+
 	// Warm Boot
 	// ---------
 
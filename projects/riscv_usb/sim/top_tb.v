@@ -88,6 +88,27 @@ module top_tb;
 	pullup(uart_tx);
 	pullup(uart_rx);
 
+	// Benchmark markers
+	// -----------------
+	// Firmware writes to 0x80000004 (ignored by the hardware). For each
+	// 'end' marker (bit 0 = 1), report the number of cycles since the
+	// 'start' marker (bit 0 = 0) with the same ID.
+
+	reg [31:0] bench_cycle = 0;
+	reg [31:0] bench_start [0:15];
+
+	always @(posedge dut_I.clk_24m)
+	begin
+		bench_cycle <= bench_cycle + 1;
+
+		if (dut_I.wb_cyc[0] & dut_I.wb_ack[0] & dut_I.wb_we & (dut_I.wb_addr[2:0] == 3'b001)) begin
+			if (~dut_I.wb_wdata[0])
+				bench_start[dut_I.wb_wdata[4:1]] <= bench_cycle;
+			else
+				$display("[bench] ID %2d : %d cycles", dut_I.wb_wdata[4:1], bench_cycle - bench_start[dut_I.wb_wdata[4:1]]);
+		end
+	end
+
 	spiflash flash_I (
 		.csb(spi_flash_cs_n),
 		.clk(spi_clk),
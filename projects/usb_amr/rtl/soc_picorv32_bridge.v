@@ -14,7 +14,8 @@ module soc_picorv32_bridge #(
 	parameter integer WB_DW  = 32,
 	parameter integer WB_AW  = 16,
 	parameter integer WB_AI  =  2,
-	parameter integer WB_REG =  0	// [0] = cyc / [1] = addr/wdata/wstrb / [2] = ack/rdata
+	parameter integer WB_REG =  0,	// [0] = cyc / [1] = addr/wdata/wstrb / [2] = ack/rdata
+	parameter integer WB_POST = 0	// Mask of slaves where writes are posted
 )(
 	/* PicoRV32 bus */
 	input  wire [31:0] pb_addr,
@@ -62,6 +63,14 @@ module soc_picorv32_bridge #(
 	(* keep *) wire [WB_N-1:0] wb_match;
 	(* keep *) wire wb_cyc_rst;
 
+	wire [31:0] wb_pb_addr;
+	wire [31:0] wb_pb_wdata;
+	wire [ 3:0] wb_pb_wstrb;
+	wire        wb_pb_valid;
+
+	wire wb_post_busy;
+	wire wb_post_ack;
+
 	reg  [31:0] wb_rdata_or;
 	wire [31:0] wb_rdata_out;
 	wire wb_rdy;
@@ -92,14 +101,85 @@ module soc_picorv32_bridge #(
 		ram_rdy <= ram_sel && ~ram_rdy;
 
 
+	genvar i;
+
+
+	// Posted writes
+	// -------------
+	// Writes to the slaves selected in WB_POST are acked to the CPU right
+	// away and stored in a one-entry buffer that then performs the actual
+	// wishbone cycle, while the CPU carries on (RAM accesses can proceed
+	// in parallel). Any other wishbone access waits for the buffer to drain.
+	//
+	// With the usual registered ack slaves, each wishbone access takes
+	// 2 cycles and so does draining the buffer (a new write can be loaded
+	// in the cycle the pending one is acked). So the gain is the CPU side:
+	// a posted store completes in 1 cycle instead of 2. Since picorv32
+	// needs at least 2 cycles to fetch the next instruction from RAM, the
+	// buffer is always empty again when the next store comes in.
+
+	if (WB_POST != 0) begin
+		// Signals
+		wire [WB_N-1:0] pw_match;
+		wire pw_req;
+		wire pw_load;
+
+		reg  pw_valid;
+		reg  [31:0] pw_addr;
+		reg  [31:0] pw_wdata;
+		reg  [ 3:0] pw_wstrb;
+
+		// Is the current CPU request a write that can be posted ?
+		for (i=0; i<WB_N; i=i+1)
+			assign pw_match[i] = (pb_addr[27:24] == i);
+
+		assign pw_req  = pb_valid & pb_addr[31] & |pb_wstrb & |(pw_match & WB_POST);
+
+		// Load when empty or when the current write completes
+		assign pw_load = pw_req & (~pw_valid | wb_rdy);
+
+		always @(posedge clk)
+			if (rst)
+				pw_valid <= 1'b0;
+			else
+				pw_valid <= pw_load | (pw_valid & ~wb_rdy);
+
+		always @(posedge clk)
+			if (pw_load) begin
+				pw_addr  <= pb_addr;
+				pw_wdata <= pb_wdata;
+				pw_wstrb <= pb_wstrb;
+			end
+
+		// Wishbone access source : buffer if not empty, else CPU (except
+		// for writes that are going to be posted)
+		assign wb_pb_addr  = pw_valid ? pw_addr  : pb_addr;
+		assign wb_pb_wdata = pw_valid ? pw_wdata : pb_wdata;
+		assign wb_pb_wstrb = pw_valid ? pw_wstrb : pb_wstrb;
+		assign wb_pb_valid = pw_valid | (pb_valid & ~pw_req);
+
+		// Status to the CPU side
+		assign wb_post_busy = pw_valid;
+		assign wb_post_ack  = pw_load;
+	end else begin
+		// Direct connection
+		assign wb_pb_addr  = pb_addr;
+		assign wb_pb_wdata = pb_wdata;
+		assign wb_pb_wstrb = pb_wstrb;
+		assign wb_pb_valid = pb_valid;
+
+		assign wb_post_busy = 1'b0;
+		assign wb_post_ack  = 1'b0;
+	end
+
+
 	// Wishbone
 	// --------
 	// wb[x] = 0x8x000000 - 0x8xffffff
 
 	// Access Cycle
-	genvar i;
 	for (i=0; i<WB_N; i=i+1)
-		assign wb_match[i] = (pb_addr[27:24] == i);
+		assign wb_match[i] = (wb_pb_addr[27:24] == i);
 
 	if (WB_REG & 1) begin
 		// Register
@@ -125,10 +205,10 @@ module soc_picorv32_bridge #(
 
 		always @(posedge clk)
 		begin
-			wb_addr_reg  <= pb_addr[WB_AW+WB_AI-1:WB_AI];
-			wb_wdata_reg <= pb_wdata[WB_DW-1:0];
-			wb_wmsk_reg  <= ~pb_wstrb[(WB_DW/8)-1:0];
-			wb_we_reg    <= |pb_wstrb;
+			wb_addr_reg  <= wb_pb_addr[WB_AW+WB_AI-1:WB_AI];
+			wb_wdata_reg <= wb_pb_wdata[WB_DW-1:0];
+			wb_wmsk_reg  <= ~wb_pb_wstrb[(WB_DW/8)-1:0];
+			wb_we_reg    <= |wb_pb_wstrb;
 		end
 
 		assign wb_addr  = wb_addr_reg;
@@ -137,10 +217,10 @@ module soc_picorv32_bridge #(
 		assign wb_we    = wb_we_reg;
 	end else begin
 		// Direct connection
-		assign wb_addr  = pb_addr[WB_AW+WB_AI-1:WB_AI];
-		assign wb_wdata = pb_wdata[WB_DW-1:0];
-		assign wb_wmsk  = pb_wstrb[(WB_DW/8)-1:0];
-		assign wb_we    = |pb_wstrb;
+		assign wb_addr  = wb_pb_addr[WB_AW+WB_AI-1:WB_AI];
+		assign wb_wdata = wb_pb_wdata[WB_DW-1:0];
+		assign wb_wmsk  = wb_pb_wstrb[(WB_DW/8)-1:0];
+		assign wb_we    = |wb_pb_wstrb;
 	end
 
 	// Ack / Read-Data
@@ -166,12 +246,12 @@ module soc_picorv32_bridge #(
 			else
 				wb_rdata_reg <= wb_rdata_or;
 
-		assign wb_cyc_rst = ~pb_valid | ~pb_addr[31] | wb_rdy_reg;
+		assign wb_cyc_rst = ~wb_pb_valid | ~wb_pb_addr[31] | wb_rdy_reg;
 		assign wb_rdy = wb_rdy_reg;
 		assign wb_rdata_out = wb_rdata_reg;
 	end else begin
 		// Direct connection
-		assign wb_cyc_rst = ~pb_valid | ~pb_addr[31];
+		assign wb_cyc_rst = ~wb_pb_valid | ~wb_pb_addr[31];
 		assign wb_rdy = |wb_ack;
 		assign wb_rdata_out = wb_rdata_or;
 	end
@@ -180,7 +260,7 @@ module soc_picorv32_bridge #(
 	// Final data combining
 	// --------------------
 
-	assign pb_rdata = ram_rdata | wb_rdata_out;
-	assign pb_ready = ram_rdy | wb_rdy;
+	assign pb_rdata = ram_rdata | (wb_post_busy ? 32'h00000000 : wb_rdata_out);
+	assign pb_ready = ram_rdy | (wb_rdy & ~wb_post_busy) | wb_post_ack;
 
 endmodule // soc_picorv32_bridge
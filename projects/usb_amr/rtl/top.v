@@ -86,6 +86,7 @@ module top (
 		.WB_N    (WB_N),
 		.WB_DW   (WB_DW),
 		.WB_AW   (WB_AW),
+		.WB_POST ((1 << 1) | (1 << 6)),	/* UART & MC97 */
 		.SPRAM_AW(SPRAM_AW)
 	) base_I (
 		.wb_addr (wb_addr),
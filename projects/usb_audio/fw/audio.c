@@ -30,6 +30,7 @@
 #include "console.h"
 #include "led.h"
 #include "mini-printf.h"
+#include "perf.h"
 #include "spi.h"
 #include <no2usb/usb.h>
 #include <no2usb/usb_ac_proto.h>
@@ -309,7 +310,7 @@ pcm_usb_set_active(bool active)
 		pcm_usb_flow_stop();
 }
 
-static void
+static void __fast_text
 pcm_poll(void)
 {
 	/* Check if enough space in FIFO */
@@ -782,11 +783,17 @@ audio_init(void)
 	usb_register_function_driver(&_audio_drv);
 }
 
+static struct perf_stat ps_pcm  = { .name = "pcm_poll " };
+static struct perf_stat ps_midi = { .name = "midi_poll" };
+
 void
 audio_poll(void)
 {
-	pcm_poll();
-	midi_poll();
+	PERF_SCOPE(&ps_pcm)
+		pcm_poll();
+
+	PERF_SCOPE(&ps_midi)
+		midi_poll();
 }
 
 void
@@ -797,4 +804,9 @@ audio_debug_print(void)
 	printf("Audio PCM tick       : %04x\n", csr >> 16);
 	printf("Audio PCM FIFO level : %d\n", (csr >> 4) & 0xfff);
 	printf("Audio PCM State      : %d\n", csr & 3);
+
+	perf_stat_print(&ps_pcm);
+	perf_stat_print(&ps_midi);
+	perf_stat_reset(&ps_pcm);
+	perf_stat_reset(&ps_midi);
 }
@@ -23,6 +23,8 @@
 
 #pragma once
 
+#define FASTRAM_BASE	0x00010000
+
 #define UART_BASE	0x81000000
 #define SPI_BASE	0x82000000
 #define LED_BASE	0x83000000
@@ -30,3 +32,4 @@
 #define USB_DATA_BASE	0x85000000
 #define AUDIO_PCM_BASE	0x86000000
 #define MIDI_BASE	0x87000000
+#define PERF_BASE	0x88000000
@@ -34,6 +34,7 @@
 #include "console.h"
 #include "led.h"
 #include "mini-printf.h"
+#include "perf.h"
 #include "spi.h"
 #include "utils.h"
 #include "config.h"
@@ -73,6 +74,8 @@ boot_dfu(void)
 	*boot = (1 << 2) | (1 << 0);
 }
 
+static struct perf_stat ps_usb = { .name = "usb_poll " };
+
 void
 usb_dfu_rt_cb_reboot(void)
 {
@@ -99,6 +102,9 @@ main()
 	/* SPI */
 	spi_init();
 
+	/* Perf counters: monitor USB core/data and PCM accesses */
+	perf_init(PERF_SLAVE(4) | PERF_SLAVE(5) | PERF_SLAVE(6));
+
 	/* Enable USB directly */
 	serial_no_init();
 	usb_init(&app_stack_desc);
@@ -131,6 +137,8 @@ main()
 			{
 			case 'p':
 				audio_debug_print();
+				perf_stat_print(&ps_usb);
+				perf_stat_reset(&ps_usb);
 				break;
 			case 'b':
 				boot_dfu();
@@ -147,7 +155,9 @@ main()
 		}
 
 		/* USB poll */
-		usb_poll();
+		PERF_SCOPE(&ps_usb)
+			usb_poll();
+
 		audio_poll();
 	}
 }
@@ -0,0 +1,128 @@
+/*
+ * soc_perf.v
+ *
+ * vim: ts=4 sw=4
+ *
+ * Copyright (C) 2020  Sylvain Munaut <tnt@246tNt.com>
+ * SPDX-License-Identifier: CERN-OHL-P-2.0
+ */
+
+`default_nettype none
+
+module soc_perf #(
+	parameter integer WB_N = 8
+)(
+	// Bus monitor (from the bridge side of the wishbone bus)
+	input  wire [WB_N-1:0] mon_cyc,
+	input  wire [WB_N-1:0] mon_ack,
+
+	// Wishbone slave
+	input  wire [ 1:0] wb_addr,
+	output reg  [31:0] wb_rdata,
+	input  wire [31:0] wb_wdata,
+	input  wire        wb_we,
+	input  wire        wb_cyc,
+	output wire        wb_ack,
+
+	// Clock / Reset
+	input  wire clk,
+	input  wire rst
+);
+
+	// Register map
+	// ------------
+	//
+	// 0 : CSR          [31] clear access/wait counters (W)
+	//                  [WB_N-1:0] monitored slave mask (RW)
+	// 1 : Cycles       Free running cycle counter (R)
+	// 2 : Accesses     Completed accesses to monitored slaves (R)
+	// 3 : Wait states  Cycles spent waiting on monitored slaves (R)
+	//
+
+	// Signals
+	// -------
+
+	// Wishbone
+	reg  b_ack;
+	reg  b_we_csr;
+	wire b_rd_rst;
+
+	// Control
+	reg  [WB_N-1:0] mon_mask;
+	reg             cnt_clr;
+
+	// Counters
+	reg  [31:0] cnt_cycle;
+	reg  [31:0] cnt_access;
+	reg  [31:0] cnt_wait;
+
+	wire mon_sel;
+
+
+	// Wishbone interface
+	// ------------------
+
+	// Ack
+	always @(posedge clk)
+		b_ack <= wb_cyc & ~b_ack;
+
+	assign wb_ack = b_ack;
+
+	// Write
+	always @(posedge clk)
+		if (b_ack)
+			b_we_csr <= 1'b0;
+		else
+			b_we_csr <= wb_cyc & wb_we & (wb_addr == 2'b00);
+
+	always @(posedge clk)
+		if (rst)
+			mon_mask <= 0;
+		else if (b_we_csr)
+			mon_mask <= wb_wdata[WB_N-1:0];
+
+	always @(posedge clk)
+		cnt_clr <= b_we_csr & wb_wdata[31];
+
+	// Read
+	assign b_rd_rst = ~wb_cyc | b_ack;
+
+	always @(posedge clk)
+		if (b_rd_rst)
+			wb_rdata <= 32'h00000000;
+		else
+			case (wb_addr)
+				2'b00:   wb_rdata <= { {(32-WB_N){1'b0}}, mon_mask };
+				2'b01:   wb_rdata <= cnt_cycle;
+				2'b10:   wb_rdata <= cnt_access;
+				2'b11:   wb_rdata <= cnt_wait;
+				default: wb_rdata <= 32'hxxxxxxxx;
+			endcase
+
+
+	// Counters
+	// --------
+
+	// Free running cycle counter
+	always @(posedge clk)
+		if (rst)
+			cnt_cycle <= 0;
+		else
+			cnt_cycle <= cnt_cycle + 1;
+
+	// Monitored slaves
+	assign mon_sel = |(mon_cyc & mon_mask);
+
+	always @(posedge clk)
+		if (rst | cnt_clr)
+			cnt_access <= 0;
+		else
+			cnt_access <= cnt_access + (mon_sel & |(mon_ack & mon_mask));
+
+	always @(posedge clk)
+		if (rst | cnt_clr)
+			cnt_wait <= 0;
+		else
+			cnt_wait <= cnt_wait + (mon_sel & ~|(mon_ack & mon_mask));
+
+endmodule // soc_perf
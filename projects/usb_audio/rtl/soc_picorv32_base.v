@@ -14,7 +14,9 @@ module soc_picorv32_base #(
 	parameter integer WB_N  =  6,
 	parameter integer WB_DW = 32,
 	parameter integer WB_AW = 16,
+	parameter integer WB_POST = 0,		/* Mask of slaves with posted writes */
 	parameter integer SPRAM_AW = 14,	/* 14 => 64k, 15 => 128k */
+	parameter integer FASTRAM_AW = 0,	/* 0 => none, 9 => 2k, 10 => 4k */
 
 	/* auto */
 	parameter integer WB_MW = WB_DW / 8,
@@ -47,6 +49,14 @@ module soc_picorv32_base #(
 	wire [31:0] mem_wdata;
 	wire [ 3:0] mem_wstrb;
 
+	wire        mem_la_read;
+	wire [31:0] mem_la_addr;
+
+	// Bridge bus
+	wire        pb_valid;
+	wire        pb_ready;
+	wire [31:0] pb_rdata;
+
 	// RAM
 		// BRAM
 	wire [ 7:0] bram_addr;
@@ -87,7 +97,9 @@ module soc_picorv32_base #(
 		.mem_addr  (mem_addr),
 		.mem_wdata (mem_wdata),
 		.mem_wstrb (mem_wstrb),
-		.mem_rdata (mem_rdata)
+		.mem_rdata (mem_rdata),
+		.mem_la_read (mem_la_read),
+		.mem_la_addr (mem_la_addr)
 	);
 
 
@@ -98,14 +110,15 @@ module soc_picorv32_base #(
 		.WB_N (WB_N),
 		.WB_DW(WB_DW),
 		.WB_AW(WB_AW),
-		.WB_AI(WB_AI)
+		.WB_AI(WB_AI),
+		.WB_POST(WB_POST)
 	) pb_I (
 		.pb_addr     (mem_addr),
-		.pb_rdata    (mem_rdata),
+		.pb_rdata    (pb_rdata),
 		.pb_wdata    (mem_wdata),
 		.pb_wstrb    (mem_wstrb),
-		.pb_valid    (mem_valid),
-		.pb_ready    (mem_ready),
+		.pb_valid    (pb_valid),
+		.pb_ready    (pb_ready),
 		.bram_addr   (bram_addr),
 		.bram_rdata  (bram_rdata),
 		.bram_wdata  (bram_wdata),
@@ -128,6 +141,66 @@ module soc_picorv32_base #(
 	);
 
 
+	// Fast memory
+	// -----------
+	// FASTRAM : 0x00010000 -> 0x0001ffff (EBR, 1 << FASTRAM_AW words)
+	//
+	// This is outside the bridge and addressed using the PicoRV32 look-ahead
+	// interface so that reads (including instruction fetches) complete with
+	// zero wait states. Writes also complete in the same cycle.
+
+	if (FASTRAM_AW > 0) begin
+		wire                  fr_sel;
+		wire                  fr_ready;
+		reg                   fr_rd_ok;
+		wire [FASTRAM_AW-1:0] fr_addr;
+		wire           [31:0] fr_rdata;
+		wire                  fr_we;
+
+		// Decode
+		assign fr_sel = mem_valid & (mem_addr[31:16] == 16'h0001);
+
+		// Address : Look-ahead for new reads, current address otherwise
+		assign fr_addr = mem_la_read ? mem_la_addr[FASTRAM_AW+1:2] : mem_addr[FASTRAM_AW+1:2];
+
+		// Read data is valid if the address was presented in the previous
+		// cycle, either through look-ahead or because we had to wait
+		always @(posedge clk)
+			if (rst)
+				fr_rd_ok <= 1'b0;
+			else
+				fr_rd_ok <= mem_la_read ? (mem_la_addr[31:16] == 16'h0001) : (fr_sel & ~fr_ready);
+
+		assign fr_we    = fr_sel & |mem_wstrb;
+		assign fr_ready = fr_sel & (fr_rd_ok | |mem_wstrb);
+
+		// Memory
+		soc_bram #(
+			.AW(FASTRAM_AW)
+		) fastram_I (
+			.addr  (fr_addr),
+			.rdata (fr_rdata),
+			.wdata (mem_wdata),
+			.wmsk  (~mem_wstrb),
+			.we    (fr_we),
+			.clk   (clk)
+		);
+
+		// Bus muxing
+		assign pb_valid  = mem_valid & ~fr_sel;
+		assign mem_ready = fr_ready | pb_ready;
+		assign mem_rdata = fr_sel ? fr_rdata : pb_rdata;
+
+	end else begin
+
+		// Direct connection to bridge
+		assign pb_valid  = mem_valid;
+		assign mem_ready = pb_ready;
+		assign mem_rdata = pb_rdata;
+
+	end
+
+
 	// Local memory
 	// ------------
 
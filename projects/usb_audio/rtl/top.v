@@ -46,7 +46,8 @@ module top (
 );
 
 	localparam integer SPRAM_AW = 14; /* 14 => 64k, 15 => 128k */
-	localparam integer WB_N  =  8;
+	localparam integer FASTRAM_AW = 9; /* 9 => 2k of EBR for hot code */
+	localparam integer WB_N  =  9;
 
 	localparam integer WB_DW = 32;
 	localparam integer WB_AW = 16;
@@ -89,7 +90,9 @@ module top (
 		.WB_N    (WB_N),
 		.WB_DW   (WB_DW),
 		.WB_AW   (WB_AW),
-		.SPRAM_AW(SPRAM_AW)
+		.WB_POST ((1 << 1) | (1 << 6)),	/* UART & PCM FIFO */
+		.SPRAM_AW(SPRAM_AW),
+		.FASTRAM_AW(FASTRAM_AW)
 	) base_I (
 		.wb_addr (wb_addr),
 		.wb_rdata(wb_rdata_flat),
@@ -239,6 +242,25 @@ module top (
 	);
 
 
+	// Perf counters [8]
+	// -------------
+
+	soc_perf #(
+		.WB_N(WB_N)
+	) perf_I (
+		.mon_cyc  (wb_cyc),
+		.mon_ack  (wb_ack),
+		.wb_addr  (wb_addr[1:0]),
+		.wb_rdata (wb_rdata[8]),
+		.wb_wdata (wb_wdata),
+		.wb_we    (wb_we),
+		.wb_cyc   (wb_cyc[8]),
+		.wb_ack   (wb_ack[8]),
+		.clk      (clk_24m),
+		.rst      (rst)
+	);
+
+
 	// Warm Boot
 	// ---------
 